@@ -55,9 +55,21 @@ std::string abstract_module::to_string( powering_status const& a_status )
     return "";
 }
 
+void abstract_module::handle_broadcast_event( event_envelope const& a_envelope )
+{
+    handle_event( a_envelope.make_event() );
+}
+
+module_id abstract_module::get_task_runner_module_id()
+{
+    static module_id const s_task_runner_module_id = module_name_registry::intern( s_task_runner_module_name );
+    return s_task_runner_module_id;
+}
+
 void abstract_module::set_name( std::string a_module_name )
 {
     m_module_name = a_module_name;
+    m_module_id = module_name_registry::intern( m_module_name );
 }
 
 void abstract_module::set_power_status( powering_status a_status )
@@ -72,11 +84,11 @@ void abstract_module::set_power_status( powering_status a_status )
         locker.unlock();
 
         std::shared_ptr<framework_event> event_;
-        event_ = std::make_shared<framework_event>();
+        event_ = make_task<framework_event>();
         event_->m_module_name = m_module_name;
         event_->m_event_type = event_type::power_status_changed;
         event_->set_source_module( m_module_name );
-        framework_manager::get_instance().get_thread_manager().post_task( event_ );
+        framework_manager::get_instance().get_thread_manager().post_task( std::move( event_ ) );
     }
 }
 
@@ -97,6 +109,7 @@ std::optional<int> abstract_module::get_scheduled_thread_id()const
         }
         return std::nullopt;
     case module_type::sequence_executing:
+    case module_type::dedicated_thread:
         {
             std::string const& name = get_name();
             uint64_t id = 0;
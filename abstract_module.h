@@ -28,12 +28,14 @@
 #include <shared_mutex>
 
 #include "framework_export.h"
+#include "module_id.h"
 
 namespace framework
 {
 
 class abstract_task;
 class framework_event;
+class event_envelope;
 class module_task_handler;
 
 class FRAMEWORK_EXPORT abstract_module
@@ -48,6 +50,8 @@ public:
         execute_task_when_post = 0x03, // all tasks related with this module will be execute when post immediately
         handler_shchedule = 0x04,      // all tasks related with this module will be scheduled by handler if a handler registered.
                                        // otherwise, will be sequentially executed.
+        dedicated_thread = 0x05,       // all tasks related with this module will be sequentially executed by its own thread,
+                                       // which never executes other modules' tasks.
     };
 
     enum class powering_status : uint8_t
@@ -83,15 +87,32 @@ public:
     virtual void handle_task( std::shared_ptr<abstract_task> a_task ) = 0;
 
     /**
-     * Handle a module event.
+     * Handle a module event
      */
     virtual void handle_event( std::shared_ptr<framework_event> a_event ) = 0;
 
+    /**
+     * Handle a broadcast event. By default handle_event gets a copy of it for this
+     * module. Override it to read the event shared by all modules without the copy,
+     * a_envelope.get_event() may be read by other modules at the same time.
+     */
+    virtual void handle_broadcast_event( event_envelope const& a_envelope );
+
     std::string const& get_name()const
     {
         return m_module_name;
     }
 
+    module_id get_module_id()const
+    {
+        return m_module_id;
+    }
+
+    /**
+     * The id of s_task_runner_module_name, tasks without a module run there.
+     */
+    static module_id get_task_runner_module_id();
+
     module_type const& get_module_type()const
     {
         return m_module_type;
@@ -140,6 +161,7 @@ private:
 
     // After the module created, should not change name and type. So no need to protect with mutex.
     std::string m_module_name;
+    module_id m_module_id = s_no_module_id;
     module_type m_module_type = module_type::concurrently_executing;
 
     mutable std::shared_mutex m_mutex;
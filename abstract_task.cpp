@@ -44,20 +44,67 @@ std::string source_position::to_string()const
     return str;
 }
 
+task_debug_info& abstract_task::get_own_debug_info()
+{
+    if( !m_debug )
+    {
+        m_debug = std::allocate_shared<task_debug_info>( task_allocator<task_debug_info>() );
+    }
+    else if( m_debug.use_count() > 1 )
+    {
+        m_debug = std::allocate_shared<task_debug_info>( task_allocator<task_debug_info>(), *m_debug );
+    }
+    return *m_debug;
+}
+
+void abstract_task::set_debug_info( std::string a_debug )
+{
+#if FRAMEWORK_ENABLE_TASK_DEBUG_INFO
+    if( debug_info_policy::keep == m_debug_info_policy )
+    {
+        get_own_debug_info().m_debug_info = std::move( a_debug );
+    }
+#endif
+}
+
+std::string const& abstract_task::get_debug_info()const
+{
+    static std::string const s_empty;
+    return m_debug ? m_debug->m_debug_info : s_empty;
+}
+
+void abstract_task::set_position( source_position a_pos )
+{
+#if FRAMEWORK_ENABLE_TASK_DEBUG_INFO
+    if( debug_info_policy::keep == m_debug_info_policy )
+    {
+        get_own_debug_info().m_position = a_pos;
+    }
+#endif
+}
+
+source_position const& abstract_task::get_position()const
+{
+    static source_position const s_empty;
+    return m_debug ? m_debug->m_position : s_empty;
+}
+
 std::shared_ptr<abstract_task> abstract_task::clone()const
 {
-    std::shared_ptr<abstract_task> ret = std::make_shared<abstract_task>();
+    std::shared_ptr<abstract_task> ret = make_task<abstract_task>();
     copy_to( ret );
     return ret;
 }
 
 void abstract_task::copy_to( std::shared_ptr<abstract_task> a_tsk )const
 {
-    a_tsk->m_debug_info = m_debug_info;
-    a_tsk->m_position = m_position;
-    a_tsk->m_source_name = m_source_name;
-    a_tsk->m_target_name = m_target_name;
+    a_tsk->m_debug = m_debug;
+    a_tsk->m_source_id = m_source_id;
+    a_tsk->m_target_id = m_target_id;
     a_tsk->m_task_type = m_task_type;
+    a_tsk->m_priority = m_priority;
+    a_tsk->m_deadline = m_deadline;
+    a_tsk->m_expiry_time = m_expiry_time;
 }
 
 }
@@ -21,12 +21,16 @@
 */
 
 #pragma once
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <string>
 #include <memory>
 
 #include "framework_export.h"
+#include "module_id.h"
+#include "task_kind.h"
+#include "task_pool.h"
 
 namespace framework
 {
@@ -52,6 +56,41 @@ struct source_position
 
 #define source_here source_position( __FILE__, __LINE__ )
 
+/**
+ * Define FRAMEWORK_ENABLE_TASK_DEBUG_INFO as 0 when building the framework to compile
+ * the debug info and source position of tasks out, setting them does nothing then.
+ * Debug builds keep them by default. Only the framework sources test it, so user code
+ * built with another setting still links with the same abstract_task.
+ */
+#ifndef FRAMEWORK_ENABLE_TASK_DEBUG_INFO
+#ifdef NDEBUG
+#define FRAMEWORK_ENABLE_TASK_DEBUG_INFO 0
+#else
+#define FRAMEWORK_ENABLE_TASK_DEBUG_INFO 1
+#endif
+#endif
+
+/**
+ * Debug metadata of a task. Kept out of the task and shared by its clones, so a
+ * task without it carries only an empty pointer. A task changes it in place
+ * unless a clone shares it.
+ */
+struct task_debug_info
+{
+    std::string m_debug_info;
+    source_position m_position;
+};
+
+/**
+ * Whether a task class keeps the debug metadata set on it. A class posted at a
+ * high rate may drop it in all builds.
+ */
+enum class debug_info_policy : uint8_t
+{
+    keep = 0,
+    drop = 1
+};
+
 enum class task_type : uint16_t
 {
     normal_type = 0,
@@ -59,6 +98,19 @@ enum class task_type : uint16_t
     framework_event = 2
 };
 
+/**
+ * Higher priority tasks are scheduled first. Lower priority ones still get a
+ * share of the workers, a flood of higher priority tasks will not starve them.
+ */
+enum class task_priority : uint8_t
+{
+    high = 0,
+    normal = 1,
+    background = 2
+};
+
+constexpr size_t s_task_priority_count = 3;
+
 class FRAMEWORK_EXPORT abstract_task
 {
 
@@ -70,22 +122,45 @@ public:
 
     std::string const& get_target_module()const
     {
-        return m_target_name;
+        return module_name_registry::get_name( m_target_id );
     }
 
     virtual void set_target_module( std::string a_module )
     {
-        m_target_name = a_module;
+        m_target_id = module_name_registry::intern( a_module );
+    }
+
+    module_id get_target_module_id()const
+    {
+        return m_target_id;
+    }
+
+    /**
+     * Same as set_target_module, without looking up the name.
+     */
+    void set_target_module_id( module_id a_module )
+    {
+        m_target_id = a_module;
     }
 
     std::string const& get_source_module()const
     {
-        return m_source_name;
+        return module_name_registry::get_name( m_source_id );
     }
 
     void set_source_module( std::string a_module )
     {
-        m_source_name = a_module;
+        m_source_id = module_name_registry::intern( a_module );
+    }
+
+    module_id get_source_module_id()const
+    {
+        return m_source_id;
+    }
+
+    void set_source_module_id( module_id a_module )
+    {
+        m_source_id = a_module;
     }
 
     void set_task_type( task_type a_type )
@@ -98,24 +173,65 @@ public:
         return m_task_type;
     }
 
-    void set_debug_info( std::string a_debug )
+    task_kind get_task_kind()const
+    {
+        return m_task_kind;
+    }
+
+    void set_debug_info( std::string a_debug );
+
+    std::string const& get_debug_info()const;
+
+    void set_position( source_position a_pos );
+
+    void set_priority( task_priority a_priority )
+    {
+        m_priority = a_priority;
+    }
+
+    task_priority get_priority()const
+    {
+        return m_priority;
+    }
+
+    source_position const& get_position()const;
+
+    /**
+     * Concurrently executing tasks waiting for a worker are picked earliest deadline
+     * first, the ones without deadline go after them.
+     */
+    void set_deadline( std::chrono::steady_clock::time_point a_deadline )
+    {
+        m_deadline = a_deadline;
+    }
+
+    std::chrono::steady_clock::time_point get_deadline()const
     {
-        m_debug_info = a_debug;
+        return m_deadline;
     }
 
-    std::string const& get_debug_info()const
+    bool has_deadline()const
     {
-        return m_debug_info;
+        return m_deadline != std::chrono::steady_clock::time_point::max();
     }
 
-    void set_position( source_position a_pos )
+    /**
+     * If the task has not started until a_expiry_time, nobody wants its result any
+     * more. It will be dropped instead of executed.
+     */
+    void set_expiry_time( std::chrono::steady_clock::time_point a_expiry_time )
+    {
+        m_expiry_time = a_expiry_time;
+    }
+
+    std::chrono::steady_clock::time_point get_expiry_time()const
     {
-        m_position = a_pos;
+        return m_expiry_time;
     }
 
-    source_position const& get_position()const
+    bool is_expired( std::chrono::steady_clock::time_point a_now )const
     {
-        return m_position;
+        return a_now > m_expiry_time;
     }
 
     virtual std::shared_ptr<abstract_task> clone()const;
@@ -127,12 +243,99 @@ public:
 
 protected:
 
-    std::string m_target_name;
-    std::string m_source_name;
-    std::string m_debug_info;
-    source_position m_position;
+    void set_task_kind( task_kind a_kind )
+    {
+        m_task_kind = a_kind;
+    }
+
+    /**
+     * Call it in constructors, it does not remove the metadata set before.
+     */
+    void set_debug_info_policy( debug_info_policy a_policy )
+    {
+        m_debug_info_policy = a_policy;
+    }
+
+    module_id m_target_id = s_no_module_id;
+    module_id m_source_id = s_no_module_id;
+    std::shared_ptr<task_debug_info> m_debug; // nullptr if never set
     task_type m_task_type = task_type::normal_type;
+    task_kind m_task_kind = s_plain_task_kind;
+    task_priority m_priority = task_priority::normal;
+    debug_info_policy m_debug_info_policy = debug_info_policy::keep;
+    std::chrono::steady_clock::time_point m_deadline = std::chrono::steady_clock::time_point::max();
+    std::chrono::steady_clock::time_point m_expiry_time = std::chrono::steady_clock::time_point::max();
+
+private:
+
+    /**
+     * The debug metadata to change, allocated first if never set, or copied first
+     * if a clone shares it.
+     */
+    task_debug_info& get_own_debug_info();
+
+    friend class thread_worker;
+    friend class thread_manager;
+
+    /**
+     * Keeps this task alive while a worker's local queue refers to it by raw pointer.
+     */
+    std::shared_ptr<abstract_task> m_queued_self;
+
+    /**
+     * When this task started waiting for a worker, in steady clock nanoseconds.
+     */
+    int64_t m_enqueue_time = 0;
 };
 
+/**
+ * The task_type derived_task and all classes derived from it have, normal_type if
+ * it has none of its own. Specialized by executable_task and framework_event.
+ */
+template<typename derived_task>
+inline constexpr task_type s_task_type_of = task_type::normal_type;
+
+/**
+ * Return a_task as derived_task if it was created as one, nullptr otherwise. It
+ * compares the task kind first. A class derived from derived_task with its own
+ * kind matches too if derived_task has its own task_type, see s_task_type_of.
+ */
+template<typename derived_task>
+derived_task* task_cast( abstract_task* a_task )
+{
+    if( !a_task )
+    {
+        return nullptr;
+    }
+
+    if( a_task->get_task_kind() == task_kind_of<derived_task>() ||
+        ( s_task_type_of<derived_task> != task_type::normal_type &&
+        a_task->get_task_type() == s_task_type_of<derived_task> ) )
+    {
+        return static_cast<derived_task*>( a_task );
+    }
+    return nullptr;
+}
+
+template<typename derived_task>
+std::shared_ptr<derived_task> task_cast( std::shared_ptr<abstract_task> const& a_task )
+{
+    if( task_cast<derived_task>( a_task.get() ) )
+    {
+        return std::static_pointer_cast<derived_task>( a_task );
+    }
+    return nullptr;
+}
+
+template<typename derived_task>
+std::shared_ptr<derived_task> task_cast( std::shared_ptr<abstract_task>&& a_task )
+{
+    if( task_cast<derived_task>( a_task.get() ) )
+    {
+        return std::static_pointer_cast<derived_task>( std::move( a_task ) );
+    }
+    return nullptr;
+}
+
 }
 
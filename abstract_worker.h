@@ -21,13 +21,17 @@
 */
 
 #pragma once
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include "abstract_task.h"
 
 namespace framework
 {
 
+struct module_task_cb;
+
 class abstract_worker : std::enable_shared_from_this<abstract_worker>
 {
 
@@ -45,10 +49,40 @@ public:
 
     virtual void post_task( std::vector<std::shared_ptr<abstract_task>> a_tasks ) = 0;
 
+    /**
+     * Queue a concurrently executing task into this worker's local queue, other
+     * workers can steal it. Can only be called in this worker's thread.
+     * Return false if the local queue is full, and a_task is untouched.
+     */
+    virtual bool push_local_task( std::shared_ptr<abstract_task>& a_task ) = 0;
+
+    /**
+     * Take the oldest task from this worker's local queue. Can be called in any
+     * thread. Return empty if there is nothing to steal.
+     */
+    virtual std::shared_ptr<abstract_task> steal_task() = 0;
+
     virtual bool is_idle_for_long_time() = 0;
 
+    /**
+     * Return true if there are tasks posted to this worker but not taken yet.
+     */
+    virtual bool has_pending_task() = 0;
+
+    /**
+     * Move the tasks posted to this worker but not taken yet to the end of a_tasks,
+     * in post order. Can only be called in this worker's thread.
+     */
+    virtual void take_posted_tasks( std::vector<std::shared_ptr<abstract_task>>& a_tasks ) = 0;
+
     virtual void exit_later() = 0;
 
+    /**
+     * Wait until the worker's thread ends. Nothing to wait if it runs in the caller's
+     * thread. Can not be called in the worker itself.
+     */
+    virtual void join() = 0;
+
     /**
      * Return this worker located in which thread
      */
@@ -56,8 +90,59 @@ public:
 
     virtual void set_worker_name( std::string a_name ) = 0;
 
+    /**
+     * Bind this worker to the CPUs in a_cpus, empty means all CPUs. It takes effect
+     * in the worker's thread before it runs the next posted tasks.
+     */
+    virtual void set_affinity( std::vector<uint32_t> a_cpus ) = 0;
+
+    /**
+     * Only execute the tasks posted to this worker, never join the pool. If a_busy_poll,
+     * keep spinning instead of parking while waiting for tasks. Call it before run,
+     * and again to change a_busy_poll.
+     */
+    virtual void set_dedicated( bool a_busy_poll ) = 0;
+
 private:
 
+    friend class thread_manager;
+
+    /**
+     * Worker pool bookkeeping, only accessed by thread_manager with its pool lock held.
+     */
+    enum class pool_state : uint8_t
+    {
+        detached,   // Not counted by the pool
+        idle,       // In the idle list
+        working
+    };
+    pool_state m_pool_state = pool_state::detached;
+    abstract_worker* m_prev_idle = nullptr;
+    abstract_worker* m_next_idle = nullptr;
+    int64_t m_idle_since = 0; // steady clock ns, when it entered the idle list
+
+    /**
+     * Sequence modules this worker is executing. Only accessed by the thread which
+     * holds this worker: the worker itself, or who took it from the idle list.
+     */
+    std::vector<module_task_cb*> m_owned_modules;
+
+    /**
+     * The only CPU this worker runs on, -1 if not pinned to one CPU. Same access rule
+     * as m_owned_modules.
+     */
+    int32_t m_pinned_cpu = -1;
+
+    /**
+     * The NUMA node this worker runs on. Written by the thread holding this worker,
+     * read by anyone.
+     */
+    std::atomic_int32_t m_numa_node = 0;
+
+    /**
+     * The dedicated thread module this worker serves, set before it runs.
+     */
+    module_task_cb* m_dedicated_module = nullptr;
 };
 
 }
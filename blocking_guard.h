@@ -0,0 +1,55 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#pragma once
+#include "framework_export.h"
+
+namespace framework
+{
+
+/**
+ * Declare that the current task is about to block, for example waiting for a
+ * condition or doing file I/O. While it lives, the worker does not count as a
+ * running one, thread manager starts a compensation worker if no worker is idle,
+ * and retires it after the blocking is over. Nested guards count once.
+ *
+ * Outside a pool worker, it does nothing.
+ */
+class FRAMEWORK_EXPORT blocking_guard
+{
+
+public:
+
+    blocking_guard();
+
+    ~blocking_guard();
+
+    blocking_guard( const blocking_guard& ) = delete;
+    blocking_guard& operator=( const blocking_guard& ) = delete;
+
+private:
+
+    bool m_entered = false;
+};
+
+}
+
@@ -23,6 +23,7 @@
 #pragma once
 #include "abstract_task.h"
 #include "abstract_module.h"
+#include "unique_function.h"
 
 namespace framework
 {
@@ -32,32 +33,64 @@ class executable_task : public abstract_task
 
 public:
 
-    executable_task( std::function<bool()> a_fun )
+    /**
+     * a_fun returns true to exit current thread. A callable returning void is
+     * accepted too, it never exits the thread.
+     */
+    executable_task( unique_function<bool()> a_fun )
     {
         set_task_type( task_type::executable_task );
-        m_target_name = abstract_module::s_task_runner_module_name;
-        m_task = a_fun;
+        set_task_kind( s_executable_task_kind );
+        m_target_id = abstract_module::get_task_runner_module_id();
+        m_task = std::move( a_fun );
     }
 
     executable_task()
     {
+        set_task_kind( s_executable_task_kind );
+    }
+
+    template<typename fun_type>
+    void set_fun
+        (
+        fun_type&& a_fun,
+        std::string const& a_target_module
+        )
+    {
+        set_fun( std::forward<fun_type>( a_fun ), module_name_registry::intern( a_target_module ) );
     }
 
+    /**
+     * The result of a_fun is ignored, so it never exits current thread.
+     */
+    template<typename fun_type>
     void set_fun
         (
-        std::function<void()> a_fun,
-        std::string a_target_module
+        fun_type&& a_fun,
+        module_id a_target_module
         )
     {
         if( !m_task )
         {
             set_task_type( task_type::executable_task );
-            m_target_name = a_target_module;
-            if( a_target_module.empty() )
+            m_target_id = a_target_module;
+            if( s_no_module_id == a_target_module )
+            {
+                m_target_id = abstract_module::get_task_runner_module_id();
+            }
+
+            if constexpr( std::is_void_v<std::invoke_result_t<std::decay_t<fun_type>&>> )
+            {
+                m_task = std::forward<fun_type>( a_fun );
+            }
+            else
             {
-                m_target_name = abstract_module::s_task_runner_module_name;
+                m_task = [fun = std::forward<fun_type>( a_fun )]() mutable
+                    {
+                        fun();
+                        return false;
+                    };
             }
-            m_task_no_return = a_fun;
         }
     }
 
@@ -71,12 +104,6 @@ public:
             return m_task();
         }
 
-        if( m_task_no_return )
-        {
-            m_task_no_return();
-            return false;
-        }
-
         return false;
     }
 
@@ -87,10 +114,21 @@ public:
 
 private:
 
-    std::function<bool()> m_task;
-    std::function<void()> m_task_no_return;
+    unique_function<bool()> m_task;
 
 };
 
+template<>
+inline task_kind task_kind_of<executable_task>()
+{
+    return s_executable_task_kind;
+}
+
+/**
+ * A derived one with its own kind is still run as an executable_task.
+ */
+template<>
+inline constexpr task_type s_task_type_of<executable_task> = task_type::executable_task;
+
 }
 
@@ -43,11 +43,12 @@ public:
     framework_event()
     {
         m_task_type = task_type::framework_event;
+        m_task_kind = s_framework_event_kind;
     }
 
     std::shared_ptr<abstract_task> clone()const override
     {
-        std::shared_ptr<framework_event> task = std::make_shared<framework_event>();
+        std::shared_ptr<framework_event> task = make_task<framework_event>();
         copy_to( task );
         return task;
     }
@@ -63,5 +64,73 @@ public:
     std::string m_module_name; // See tye power_status_changed
 };
 
+/**
+ * Events derived from framework_event keep its kind unless they set their own.
+ */
+template<>
+inline task_kind task_kind_of<framework_event>()
+{
+    return s_framework_event_kind;
+}
+
+template<>
+inline constexpr task_type s_task_type_of<framework_event> = task_type::framework_event;
+
+/**
+ * Delivers a broadcast event to one module. All envelopes of a broadcast share
+ * the event, it is read only after posted. The envelope's target module is the
+ * receiving one.
+ */
+class event_envelope : public abstract_task
+{
+
+public:
+
+    event_envelope
+        (
+        std::shared_ptr<framework_event const> a_event,
+        module_id a_target_module
+        )
+        : m_event( std::move( a_event ) )
+    {
+        set_task_kind( s_event_envelope_kind );
+        m_target_id = a_target_module;
+        m_source_id = m_event->get_source_module_id();
+        m_priority = m_event->get_priority();
+        m_deadline = m_event->get_deadline();
+        m_expiry_time = m_event->get_expiry_time();
+    }
+
+    std::shared_ptr<framework_event const> const& get_event()const
+    {
+        return m_event;
+    }
+
+    /**
+     * A copy of the event for the target module only, its target module is set.
+     */
+    std::shared_ptr<framework_event> make_event()const
+    {
+        auto event_ = std::static_pointer_cast<framework_event>( m_event->clone() );
+        event_->set_target_module_id( m_target_id );
+        return event_;
+    }
+
+    std::shared_ptr<abstract_task> clone()const override
+    {
+        return make_task<event_envelope>( m_event, m_target_id );
+    }
+
+private:
+
+    std::shared_ptr<framework_event const> m_event;
+};
+
+template<>
+inline task_kind task_kind_of<event_envelope>()
+{
+    return s_event_envelope_kind;
+}
+
 }
 
@@ -24,16 +24,18 @@
 #include "framework_event.h"
 #include "timer_module.h"
 #include "log_util.h"
+#include "utils.h"
 
 #include <mutex>
+#include <thread>
 
 namespace framework
 {
 
 framework_manager& framework_manager::get_instance()
 {
-    static framework_manager instance;
-    return instance;
+    // Workers look up the modules and the schedule tables through it until they exit.
+    return get_never_destroyed<framework_manager>();
 }
 
 bool  framework_manager::is_running()const
@@ -48,21 +50,88 @@ void framework_manager::run
     bool a_occupy_current_thread
     )
 {
-    std::lock_guard<std::shared_mutex> locker( m_mutex );
-    if( m_is_running )
+    std::unique_lock<std::mutex> lifecycle_locker( m_lifecycle_mutex );
+    if( is_running() )
     {
         return;
     }
     init( std::move( a_module_maker ) );
-    m_is_running = true;
+    {
+        std::lock_guard<std::shared_mutex> locker( m_mutex );
+        m_is_running = true;
+    }
+
+    if( a_occupy_current_thread )
+    {
+        // It returns only after stop, do not block stop.
+        lifecycle_locker.unlock();
+    }
     m_thread_manager.run( a_occupy_current_thread );
 }
 
+void framework_manager::run
+    (
+    std::function<std::vector<std::shared_ptr<framework::abstract_module>>()> a_module_maker,
+    thread_manager::pool_config const& a_pool_config,
+    bool a_occupy_current_thread
+    )
+{
+    m_thread_manager.set_pool_config( a_pool_config );
+    run( std::move( a_module_maker ), a_occupy_current_thread );
+}
+
 void framework_manager::power_up()
 {
-    std::shared_ptr<framework_event> event_ = std::make_shared<framework_event>();
+    std::shared_ptr<framework_event> event_ = make_task<framework_event>();
     event_->m_event_type = event_type::power_on;
-    m_thread_manager.post_task( event_ );
+    m_thread_manager.post_task( std::move( event_ ) );
+}
+
+void framework_manager::stop( std::chrono::milliseconds a_timeout )
+{
+    std::lock_guard<std::mutex> lifecycle_locker( m_lifecycle_mutex );
+    if( !is_running() )
+    {
+        return;
+    }
+
+    if( thread_manager::get_current_worker() )
+    {
+        LogUtilError() << "Can not stop framework in its worker.";
+        return;
+    }
+
+    // Half of the time for the modules to power off, the rest for the queued tasks.
+    auto now = std::chrono::steady_clock::now();
+    auto deadline = now + a_timeout;
+    auto power_off_deadline = now + a_timeout / 2;
+    std::shared_ptr<framework_event> event_ = make_task<framework_event>();
+    event_->m_event_type = event_type::power_off;
+    m_thread_manager.post_task( std::move( event_ ) );
+    while( m_module_manager.get_power_status() != abstract_module::powering_status::power_off &&
+        std::chrono::steady_clock::now() < power_off_deadline )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+
+    if( m_module_manager.get_power_status() != abstract_module::powering_status::power_off )
+    {
+        LogUtilWarning() << "Not all modules powered off in time, stop anyway.";
+    }
+
+    auto _timer_module = m_module_manager.get_module<timer_module>( abstract_module::s_timer_module_name );
+    if( _timer_module )
+    {
+        _timer_module->stop_all_timers();
+    }
+
+    m_thread_manager.stop( deadline );
+    m_module_manager.deinitialize();
+    m_module_manager.unload_modules();
+
+    std::lock_guard<std::shared_mutex> locker( m_mutex );
+    m_is_running = false;
+    LogUtilInfo() << "framework stopped.";
 }
 
 void framework_manager::init( std::function< std::vector<std::shared_ptr<framework::abstract_module>>()> a_module_maker )
@@ -25,6 +25,8 @@
 #include "thread_manager.h"
 #include "information_manager.h"
 
+#include <chrono>
+#include <mutex>
 #include <shared_mutex>
 
 #include "framework_export.h"
@@ -37,6 +39,8 @@ class FRAMEWORK_EXPORT framework_manager
 
 public:
 
+    constexpr static std::chrono::milliseconds s_default_stop_timeout{ 3000 };
+
     static framework_manager& get_instance();
 
     thread_manager& get_thread_manager()
@@ -60,8 +64,26 @@ public:
         bool a_occupy_current_thread = false
         );
 
+    /**
+     * Same as above, and the worker pool is bounded by a_pool_config.
+     */
+    void run
+        (
+        std::function< std::vector<std::shared_ptr<framework::abstract_module>>()> a_module_maker,
+        thread_manager::pool_config const& a_pool_config,
+        bool a_occupy_current_thread = false
+        );
+
     void power_up();
 
+    /**
+     * Stop the framework in about a_timeout. Power off the modules and stop the
+     * timers, let the workers finish the queued tasks and cancel the remained ones,
+     * then join all workers and unload the modules. run can be called again after
+     * it. Can not be called in a worker.
+     */
+    void stop( std::chrono::milliseconds a_timeout = s_default_stop_timeout );
+
     bool is_running()const;
 
 private:
@@ -72,6 +94,7 @@ private:
     thread_manager m_thread_manager;
     information_manager m_info_manager;
 
+    std::mutex m_lifecycle_mutex; // Serialize run and stop
     mutable std::shared_mutex m_mutex;
     bool m_is_running = false;
 };
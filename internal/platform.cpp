@@ -25,7 +25,10 @@
 #include <algorithm>
 #include <ctime>
 #include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <ranges>
+#include <thread>
 #include <vector>
 
 #if __has_include( <stacktrace> )
@@ -41,6 +44,7 @@ typedef HRESULT( WINAPI* SetThreadNameDescription )( HANDLE hThread,
 
 #if defined(ANDROID_OS) || defined(LINUX_OS)
 #include <pthread.h>
+#include <sched.h>
 #include <sys/prctl.h>
 #include <unistd.h>
 #endif
@@ -155,7 +159,7 @@ void set_thread_name( const std::string& a_name )
         return;
 
     // Set the name for the LWP (which gets truncated to 15 characters).
-    int err = prctl( PR_SET_NAME, name.c_str() );
+    int err = prctl( PR_SET_NAME, a_name.c_str() );
     if (err < 0 && errno != EPERM)
     {
         LogUtilError() << "cannot set current thread's name";
@@ -206,6 +210,171 @@ uint64_t get_current_thread_id()
 #endif
 }
 
+bool set_current_thread_affinity( std::vector<uint32_t> const& a_cpus )
+{
+#ifdef WINDOWS_OS
+    DWORD_PTR mask = 0;
+    if( a_cpus.empty() )
+    {
+        DWORD_PTR system_mask = 0;
+        ::GetProcessAffinityMask( ::GetCurrentProcess(), &mask, &system_mask );
+    }
+
+    for( uint32_t cpu : a_cpus )
+    {
+        if( cpu >= sizeof( DWORD_PTR ) * 8 )
+        {
+            LogUtilError() << "invalid cpu: " << cpu;
+            return false;
+        }
+        mask |= static_cast< DWORD_PTR >( 1 ) << cpu;
+    }
+
+    if( 0 == ::SetThreadAffinityMask( ::GetCurrentThread(), mask ) )
+    {
+        LogUtilError() << "cannot set current thread's affinity, error: " << ::GetLastError();
+        return false;
+    }
+    return true;
+#endif
+
+#if defined(LINUX_OS)
+    cpu_set_t cpu_set;
+    CPU_ZERO( &cpu_set );
+    if( a_cpus.empty() )
+    {
+        long cpu_count = sysconf( _SC_NPROCESSORS_CONF );
+        for( long cpu = 0; cpu < cpu_count && cpu < CPU_SETSIZE; ++cpu )
+        {
+            CPU_SET( cpu, &cpu_set );
+        }
+    }
+
+    for( uint32_t cpu : a_cpus )
+    {
+        if( cpu >= CPU_SETSIZE )
+        {
+            LogUtilError() << "invalid cpu: " << cpu;
+            return false;
+        }
+        CPU_SET( cpu, &cpu_set );
+    }
+
+    int err = pthread_setaffinity_np( pthread_self(), sizeof( cpu_set ), &cpu_set );
+    if( err != 0 )
+    {
+        LogUtilError() << "cannot set current thread's affinity, error: " << err;
+        return false;
+    }
+    return true;
+#endif
+
+    LogUtilWarning() << "thread affinity is not supported on this platform.";
+    return false;
+}
+
+#if defined(LINUX_OS)
+/**
+ * Parse a cpu list like "0-3,8,10-11".
+ */
+static std::vector<uint32_t> parse_cpu_list( std::string const& a_list )
+{
+    std::vector<uint32_t> cpus;
+    size_t pos = 0;
+    while( pos < a_list.size() )
+    {
+        size_t end = a_list.find( ',', pos );
+        if( end == std::string::npos )
+        {
+            end = a_list.size();
+        }
+
+        std::string range = a_list.substr( pos, end - pos );
+        size_t dash = range.find( '-' );
+        try
+        {
+            uint32_t first = static_cast< uint32_t >( std::stoul( range.substr( 0, dash ) ) );
+            uint32_t last = dash == std::string::npos ? first :
+                static_cast< uint32_t >( std::stoul( range.substr( dash + 1 ) ) );
+            for( uint32_t cpu = first; cpu <= last; ++cpu )
+            {
+                cpus.push_back( cpu );
+            }
+        }
+        catch( std::exception const& )
+        {
+            // Empty or broken range, skip it.
+        }
+        pos = end + 1;
+    }
+    return cpus;
+}
+#endif
+
+std::vector<std::vector<uint32_t>> get_numa_nodes()
+{
+    std::vector<std::vector<uint32_t>> nodes;
+
+#ifdef WINDOWS_OS
+    ULONG highest_node = 0;
+    if( ::GetNumaHighestNodeNumber( &highest_node ) )
+    {
+        for( ULONG node = 0; node <= highest_node; ++node )
+        {
+            std::vector<uint32_t> cpus;
+            ULONGLONG mask = 0;
+            if( ::GetNumaNodeProcessorMask( static_cast< UCHAR >( node ), &mask ) )
+            {
+                for( uint32_t cpu = 0; cpu < sizeof( mask ) * 8; ++cpu )
+                {
+                    if( mask & ( 1ULL << cpu ) )
+                    {
+                        cpus.push_back( cpu );
+                    }
+                }
+            }
+            nodes.emplace_back( std::move( cpus ) );
+        }
+    }
+#endif
+
+#if defined(LINUX_OS)
+    std::error_code ec;
+    for( auto const& entry : std::filesystem::directory_iterator( "/sys/devices/system/node", ec ) )
+    {
+        std::string name = entry.path().filename().string();
+        if( name.size() <= 4 || name.compare( 0, 4, "node" ) != 0 ||
+            !std::all_of( name.begin() + 4, name.end(), []( char c ) { return c >= '0' && c <= '9'; } ) )
+        {
+            continue;
+        }
+
+        size_t node = std::stoul( name.substr( 4 ) );
+        std::ifstream cpu_list_file( entry.path() / "cpulist" );
+        std::string cpu_list;
+        std::getline( cpu_list_file, cpu_list );
+        if( nodes.size() <= node )
+        {
+            nodes.resize( node + 1 );
+        }
+        nodes[node] = parse_cpu_list( cpu_list );
+    }
+#endif
+
+    bool has_cpu = std::any_of( nodes.begin(), nodes.end(),
+        []( std::vector<uint32_t> const& a_cpus ) { return !a_cpus.empty(); } );
+    if( !has_cpu )
+    {
+        nodes.assign( 1, {} );
+        uint32_t cpu_count = std::max( std::thread::hardware_concurrency(), 1u );
+        for( uint32_t cpu = 0; cpu < cpu_count; ++cpu )
+        {
+            nodes[0].push_back( cpu );
+        }
+    }
+    return nodes;
+}
+
 std::u8string convert( std::string const& a_source )
 {
 #ifdef WINDOWS_OS
@@ -250,7 +419,7 @@ std::string convert( std::u8string const& a_source )
     WideCharToMultiByte( CP_ACP, 0, wstr.c_str(), wlen, str.data(), mlen, nullptr, nullptr );
     return str;
 #elif defined(__linux__) || defined(__APPLE__)
-    reinterpret_cast<const char*>(u8str.data());
+    return std::string( reinterpret_cast<const char*>(a_source.data()), a_source.size() );
 #else 
     LogUtilFatal() << "No implementation!";
     return std::string();
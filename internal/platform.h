@@ -98,6 +98,18 @@ FRAMEWORK_EXPORT uint64_t get_time_stamp();
 
 FRAMEWORK_EXPORT uint64_t get_current_thread_id();
 
+/**
+ * Bind current thread to the CPUs in a_cpus, empty means all CPUs. Return false
+ * if a CPU is invalid or the platform does not support it.
+ */
+FRAMEWORK_EXPORT bool set_current_thread_affinity( std::vector<uint32_t> const& a_cpus );
+
+/**
+ * CPUs of each NUMA node, indexed by node id. If NUMA information is not available,
+ * return one node with all CPUs.
+ */
+FRAMEWORK_EXPORT std::vector<std::vector<uint32_t>> get_numa_nodes();
+
 FRAMEWORK_EXPORT std::u8string convert( std::string const& a_source );
 
 FRAMEWORK_EXPORT std::string convert( std::u8string const& a_source );
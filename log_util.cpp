@@ -204,7 +204,8 @@ public:
     static constexpr int s_max_cached_line = 30;
 };
 
-static log_control_block s_log_cb;
+// Workers log through it until they exit.
+static log_control_block& s_log_cb = framework::get_never_destroyed<log_control_block>();
 
 framework::log_level framework::util_logger::s_logLevel = framework::log_level::verbose;
 
@@ -0,0 +1,88 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "module_id.h"
+#include "log_util.h"
+#include "utils.h"
+
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace framework
+{
+
+struct name_registry
+{
+    std::shared_mutex m_mutex; // Protect m_ids
+    std::unordered_map<std::string, module_id> m_ids;
+    module_id_table<std::string> m_names; // Written before the id is published
+    module_id m_next_id = s_no_module_id + 1;
+};
+
+static name_registry& get_registry()
+{
+    // Tasks of any thread resolve their target names through it.
+    return get_never_destroyed<name_registry>();
+}
+
+module_id module_name_registry::intern( std::string const& a_name )
+{
+    if( a_name.empty() )
+    {
+        return s_no_module_id;
+    }
+
+    name_registry& registry = get_registry();
+    {
+        std::shared_lock<std::shared_mutex> locker( registry.m_mutex );
+        auto it = registry.m_ids.find( a_name );
+        if( it != registry.m_ids.end() )
+        {
+            return it->second;
+        }
+    }
+
+    std::lock_guard<std::shared_mutex> locker( registry.m_mutex );
+    if( registry.m_next_id / module_id_table<std::string>::s_chunk_size >= module_id_table<std::string>::s_max_chunk_count )
+    {
+        LogUtilError() << "Too many module names, can not give an id to " << a_name;
+        return s_no_module_id;
+    }
+
+    auto [it, inserted] = registry.m_ids.try_emplace( a_name, registry.m_next_id );
+    if( inserted )
+    {
+        registry.m_names.get( registry.m_next_id ) = a_name;
+        ++registry.m_next_id;
+    }
+    return it->second;
+}
+
+std::string const& module_name_registry::get_name( module_id a_id )
+{
+    static std::string const s_empty_name;
+    std::string const* name = get_registry().m_names.find( a_id );
+    return name ? *name : s_empty_name;
+}
+
+}
+
@@ -0,0 +1,134 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "framework_export.h"
+
+namespace framework
+{
+
+/**
+ * Dense integer handle of a module name, given when the name is seen first. Tasks
+ * are routed by it through flat tables, instead of hashing the name on each hop.
+ */
+using module_id = uint32_t;
+
+/**
+ * The handle of the empty name, that is no target module.
+ */
+constexpr module_id s_no_module_id = 0;
+
+/**
+ * Flat table indexed by module_id. Slots are allocated by chunks which never move
+ * or get freed before the table, so looking up a slot takes no lock.
+ */
+template<typename element_type>
+class module_id_table
+{
+
+public:
+
+    constexpr static uint32_t s_chunk_size = 256;
+    constexpr static uint32_t s_max_chunk_count = 4096;
+
+    module_id_table() = default;
+
+    ~module_id_table()
+    {
+        for( auto& chunk : m_chunks )
+        {
+            delete[] chunk.load();
+        }
+    }
+
+    module_id_table( const module_id_table& ) = delete;
+    module_id_table& operator=( const module_id_table& ) = delete;
+
+    /**
+     * Return the slot of a_id, nullptr if the slot has not been allocated.
+     */
+    element_type* find( module_id a_id )const
+    {
+        uint32_t chunk_index = a_id / s_chunk_size;
+        if( chunk_index >= s_max_chunk_count )
+        {
+            return nullptr;
+        }
+
+        element_type* chunk = m_chunks[chunk_index].load( std::memory_order_acquire );
+        return chunk ? &chunk[a_id % s_chunk_size] : nullptr;
+    }
+
+    /**
+     * Return the slot of a_id, allocate it if need.
+     */
+    element_type& get( module_id a_id )
+    {
+        element_type* slot = find( a_id );
+        if( slot )
+        {
+            return *slot;
+        }
+
+        std::lock_guard<std::mutex> locker( m_mutex );
+        std::atomic<element_type*>& chunk = m_chunks[a_id / s_chunk_size];
+        if( !chunk.load() )
+        {
+            chunk.store( new element_type[s_chunk_size](), std::memory_order_release );
+        }
+        return chunk.load()[a_id % s_chunk_size];
+    }
+
+private:
+
+    std::mutex m_mutex; // Protect allocating chunks
+    std::atomic<element_type*> m_chunks[s_max_chunk_count] = {};
+};
+
+/**
+ * Process wide mapping between module names and module_id. A name keeps its id
+ * forever, ids are never reused.
+ */
+class FRAMEWORK_EXPORT module_name_registry
+{
+
+public:
+
+    /**
+     * Return the id of a_name, give it a new one if a_name is seen first.
+     */
+    static module_id intern( std::string const& a_name );
+
+    /**
+     * Return the name of a_id. The reference keeps valid forever. Empty if a_id
+     * has not been given.
+     */
+    static std::string const& get_name( module_id a_id );
+};
+
+}
+
@@ -68,28 +68,33 @@ void module_manager::deinitialize()
 
 void module_manager::schedule_task( std::shared_ptr<abstract_task> a_task )
 {
+    switch( a_task->get_task_kind() )
+    {
+    case s_executable_task_kind:
+        static_cast< executable_task* >( a_task.get() )->run_task();
+        return;
+    case s_framework_event_kind:
+        handle_event( std::static_pointer_cast< framework_event >( std::move( a_task ) ) );
+        return;
+    case s_event_envelope_kind:
+        handle_event_envelope( *static_cast< event_envelope* >( a_task.get() ) );
+        return;
+    default:
+        break;
+    }
+
+    // Derived events and executable tasks with their own kind.
     if( task_type::normal_type == a_task->get_task_type() )
     {
-        handle_task( a_task );
+        handle_task( std::move( a_task ) );
     }
-    else if( task_type::framework_event == a_task->get_task_type() )
+    else if( auto event_ = task_cast<framework_event>( a_task ) )
     {
-        std::shared_ptr<framework_event> event_;
-        event_ = std::dynamic_pointer_cast< framework_event >( a_task );
-        if( event_ )
-        {
-            handle_event( event_ );
-        }
-        else
-        {
-            LogUtilError() << "error task type!";
-        }
+        handle_event( std::move( event_ ) );
     }
-    else if( task_type::executable_task == a_task->get_task_type() )
+    else if( auto runnable_task = task_cast<executable_task>( a_task.get() ) )
     {
-        std::shared_ptr<executable_task> tsk;
-        tsk = std::dynamic_pointer_cast< executable_task >( a_task );
-        tsk->run_task();
+        runnable_task->run_task();
     }
     else
     {
@@ -101,14 +106,14 @@ void module_manager::handle_task( std::shared_ptr<abstract_task> a_task )
 {
     std::string const& _target_name = a_task->get_target_module();
     std::string const& _source_name = a_task->get_source_module();
-    auto _module = get_module( _target_name );
+    std::shared_ptr<abstract_module> _module = get_module_by_id( a_task->get_target_module_id() );
     if( _module )
     {
-        _module->handle_task( a_task );
+        _module->handle_task( std::move( a_task ) );
     }
     else if( _target_name == get_name() )
     {
-        handle_module_manager_task( a_task );
+        handle_module_manager_task( std::move( a_task ) );
     }
     else if( _target_name.empty() )
     {
@@ -132,14 +137,14 @@ void module_manager::handle_event( std::shared_ptr<framework_event> a_event )
     std::string const& _source_name = a_event->get_source_module();
     if( _target_name == get_name() )
     {
-        handle_local_event( a_event );
+        handle_local_event( *a_event );
         return;
     }
 
-    auto _module = get_module( _target_name );
+    std::shared_ptr<abstract_module> _module = get_module_by_id( a_event->get_target_module_id() );
     if( _module )
     {
-        _module->handle_event( a_event );
+        _module->handle_event( std::move( a_event ) );
     }
     else if( _target_name == get_name() )
     {
@@ -148,7 +153,7 @@ void module_manager::handle_event( std::shared_ptr<framework_event> a_event )
     else if( _target_name.empty() )
     {
         bool pass_to_other_module = true;
-        pass_to_other_module = handle_local_event( a_event );
+        pass_to_other_module = handle_local_event( *a_event );
         if( pass_to_other_module )
         {
             for( auto& ele : m_modules )
@@ -166,13 +171,33 @@ void module_manager::handle_event( std::shared_ptr<framework_event> a_event )
     }
 }
 
-bool module_manager::handle_local_event( std::shared_ptr<framework_event> a_event )
+void module_manager::handle_event_envelope( event_envelope const& a_envelope )
+{
+    if( a_envelope.get_target_module_id() == get_module_id() )
+    {
+        handle_local_event( *a_envelope.get_event() );
+        return;
+    }
+
+    std::shared_ptr<abstract_module> _module = get_module_by_id( a_envelope.get_target_module_id() );
+    if( _module )
+    {
+        _module->handle_broadcast_event( a_envelope );
+    }
+    else
+    {
+        LogUtilError() << "Unknown module: " << a_envelope.get_target_module() << ", from module "
+            << a_envelope.get_source_module();
+    }
+}
+
+bool module_manager::handle_local_event( framework_event const& a_event )
 {
     bool pass_all = true;
-    switch( a_event->m_event_type )
+    switch( a_event.m_event_type )
     {
     case event_type::power_status_changed:
-        pass_all = handle_module_power_changed( a_event->m_module_name );
+        pass_all = handle_module_power_changed( a_event.m_module_name );
         break;
     case event_type::power_on:
         pass_all = handle_power_on( a_event );
@@ -183,13 +208,13 @@ bool module_manager::handle_local_event( std::shared_ptr<framework_event> a_even
     case event_type::derived_type:
         break;
     default:
-        LogUtilWarning() << "event has been ignored: " << static_cast< uint16_t >( a_event->m_event_type );
+        LogUtilWarning() << "event has been ignored: " << static_cast< uint16_t >( a_event.m_event_type );
         break;
     }
     return pass_all;
 }
 
-bool module_manager::handle_power_on( std::shared_ptr<framework_event> const& a_event )
+bool module_manager::handle_power_on( framework_event const& a_event )
 {
     auto [power_on_cnt, power_off_cnt, power_oning_cnt, power_offing_cnt, total_cnt]
         = get_module_status();
@@ -215,7 +240,7 @@ bool module_manager::handle_power_on( std::shared_ptr<framework_event> const& a_
     return true;
 }
 
-bool module_manager::handle_power_off( std::shared_ptr<framework_event> const& a_event )
+bool module_manager::handle_power_off( framework_event const& a_event )
 {
     auto [power_on_cnt, power_off_cnt, power_oning_cnt, power_offing_cnt, total_cnt]
         = get_module_status();
@@ -277,14 +302,14 @@ bool module_manager::handle_module_power_changed( std::string a_module_name )
         }
 
         std::shared_ptr<executable_task> task;
-        task = std::make_shared<executable_task>( [callback, now_pwr_status]()->bool
+        task = make_task<executable_task>( [callback, now_pwr_status]()->bool
             {
                 callback( now_pwr_status );
                 return false;
             } );
         task->set_target_module( s_general_seq_task_runner_module );
         task->set_source_module( get_name() );
-        framework_manager::get_instance().get_thread_manager().post_task( task );
+        framework_manager::get_instance().get_thread_manager().post_task( std::move( task ) );
     }
 
     return true;
@@ -347,6 +372,7 @@ void module_manager::load_modules( std::function< std::vector<std::shared_ptr<fr
         if( !m_modules[ele->get_name()] )
         {
             m_modules[ele->get_name()] = ele;
+            m_modules_by_id.get( ele->get_module_id() ) = ele;
             LogUtilInfo() << "Loaded module: " << ele->get_name();
             if( ele->get_name().empty() )
             {
@@ -360,6 +386,17 @@ void module_manager::load_modules( std::function< std::vector<std::shared_ptr<fr
     }
 }
 
+void module_manager::unload_modules()
+{
+    std::lock_guard<std::shared_mutex> locker( m_pro_mutex );
+    for( auto& ele : m_modules )
+    {
+        m_modules_by_id.get( ele.second->get_module_id() ).reset();
+    }
+    m_modules.clear();
+    set_power_status( abstract_module::powering_status::power_off );
+}
+
 std::shared_ptr<abstract_module> module_manager::get_module( std::string a_name )const
 {
     auto it = m_modules.find( a_name );
@@ -370,6 +407,13 @@ std::shared_ptr<abstract_module> module_manager::get_module( std::string a_name
     return nullptr;
 }
 
+std::shared_ptr<abstract_module> module_manager::get_module_by_id( module_id a_id )const
+{
+    std::shared_lock<std::shared_mutex> locker( m_pro_mutex );
+    std::shared_ptr<abstract_module>* slot = m_modules_by_id.find( a_id );
+    return slot ? *slot : nullptr;
+}
+
 void module_manager::add_new_module( std::shared_ptr<framework::abstract_module> a_module )
 {
     if( !a_module )
@@ -382,6 +426,7 @@ void module_manager::add_new_module( std::shared_ptr<framework::abstract_module>
     if( m_modules.find( a_module->get_name() ) == m_modules.end() )
     {
         m_modules[a_module->get_name()] = a_module;
+        m_modules_by_id.get( a_module->get_module_id() ) = a_module;
         framework_manager::get_instance().get_thread_manager()
             .register_module_type( a_module->get_module_type(),
                 a_module->get_name() );
@@ -390,14 +435,14 @@ void module_manager::add_new_module( std::shared_ptr<framework::abstract_module>
         if( current_power_status == abstract_module::powering_status::power_on ||
             current_power_status == abstract_module::powering_status::power_oning )
         {
-            std::shared_ptr<framework_event> event_ = std::make_shared<framework_event>();
+            std::shared_ptr<framework_event> event_ = make_task<framework_event>();
             event_->m_event_type = event_type::power_on;
             a_module->handle_event( event_ );
         }
         else if( current_power_status == abstract_module::powering_status::power_off ||
             current_power_status == abstract_module::powering_status::power_offing )
         {
-            std::shared_ptr<framework_event> event_ = std::make_shared<framework_event>();
+            std::shared_ptr<framework_event> event_ = make_task<framework_event>();
             event_->m_event_type = event_type::power_off;
             a_module->handle_event( event_ );
         }
@@ -416,7 +461,12 @@ void module_manager::remove_module( std::string a_name )
 {
     LogUtilInfo() << "remove module " << a_name;
     std::lock_guard<std::shared_mutex> locker( m_pro_mutex );
-    m_modules.erase( a_name );
+    auto it = m_modules.find( a_name );
+    if( it != m_modules.end() )
+    {
+        m_modules_by_id.get( it->second->get_module_id() ).reset();
+        m_modules.erase( it );
+    }
 }
 
 void module_manager::handle_module_manager_task( std::shared_ptr<abstract_task> a_task )
@@ -24,6 +24,7 @@
 #include "abstract_module.h"
 #include "abstract_task.h"
 #include "framework_export.h"
+#include "module_id.h"
 
 #include <list>
 #include <memory>
@@ -35,6 +36,8 @@
 namespace framework
 {
 
+class event_envelope;
+
 class FRAMEWORK_EXPORT module_manager : public abstract_module
 {
 
@@ -55,10 +58,26 @@ public:
 
     void handle_event( std::shared_ptr<framework_event> a_event )override;
 
+    /**
+     * Hand the shared event of a broadcast to the envelope's target module.
+     */
+    void handle_event_envelope( event_envelope const& a_envelope );
+
     void load_modules( std::function< std::vector<std::shared_ptr<framework::abstract_module>>()> a_module_maker );
 
+    /**
+     * Remove all modules after deinitialize, then load_modules can be called again.
+     */
+    void unload_modules();
+
     std::shared_ptr<abstract_module> get_module( std::string a_name )const;
 
+    /**
+     * Lookup for routing tasks, nullptr if no such module. The returned one keeps
+     * the module alive while its task runs, even if it is removed meanwhile.
+     */
+    std::shared_ptr<abstract_module> get_module_by_id( module_id a_id )const;
+
     template<typename module_type>
     std::shared_ptr<module_type> get_module( std::string a_name )const
     {
@@ -82,11 +101,11 @@ private:
     /**
      * return true indicate that the event need pass to all modules if need
      */
-    bool handle_local_event( std::shared_ptr<framework_event> a_event );
+    bool handle_local_event( framework_event const& a_event );
 
-    bool handle_power_on( std::shared_ptr<framework_event> const& a_event );
+    bool handle_power_on( framework_event const& a_event );
 
-    bool handle_power_off( std::shared_ptr<framework_event> const& a_event );
+    bool handle_power_off( framework_event const& a_event );
 
     void handle_module_manager_task( std::shared_ptr<abstract_task> a_task );
 
@@ -94,8 +113,9 @@ private:
 
     std::tuple<size_t, size_t, size_t, size_t, size_t> get_module_status();
 
-    std::shared_mutex m_pro_mutex;
+    mutable std::shared_mutex m_pro_mutex;
     std::unordered_map<std::string, std::shared_ptr<abstract_module>> m_modules;
+    module_id_table<std::shared_ptr<abstract_module>> m_modules_by_id; // Mirror of m_modules, indexed by module_id, protected by m_pro_mutex
     std::function<void( powering_status )> m_power_changed_callback;
 };
 
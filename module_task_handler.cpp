@@ -22,6 +22,7 @@
 
 #include "abstract_module.h"
 #include "executable_task.h"
+#include "framework_event.h"
 #include "framework_manager.h"
 #include "log_util.h"
 #include "module_task_handler.h"
@@ -43,6 +44,7 @@ module_task_handler::module_task_handler( std::string a_task_handler_name )
     }
 
     m_task_schedule_helper_module_name = a_task_handler_name;
+    m_task_schedule_helper_module_id = module_name_registry::intern( a_task_handler_name );
     auto task_schedule_helper_module = std::make_shared<general_seq_task_runner_module>( a_task_handler_name );
     task_schedule_helper_module->initialize();
     framework_manager::get_instance().get_module_manager().add_new_module( task_schedule_helper_module );
@@ -56,10 +58,10 @@ module_task_handler::~module_task_handler()
 
 void module_task_handler::handle( std::shared_ptr<abstract_task> a_task )
 {
-    auto route_task = std::make_shared<executable_task>();
+    auto route_task = make_task<executable_task>();
     route_task->set_fun( std::bind( &module_task_handler::execute, this, std::move( a_task ) ),
-        m_task_schedule_helper_module_name );
-    framework_manager::get_instance().get_thread_manager().post_task( route_task );
+        m_task_schedule_helper_module_id );
+    framework_manager::get_instance().get_thread_manager().post_task( std::move( route_task ) );
 }
 
 std::optional<int> module_task_handler::get_current_executing_thread_id()const
@@ -72,10 +74,10 @@ std::optional<int> module_task_handler::get_current_executing_thread_id()const
 
 void module_task_handler::execute( std::shared_ptr<abstract_task> a_task )
 {
-    if( a_task->get_target_module() == abstract_module::s_task_runner_module_name ||
-        a_task->get_target_module().empty() )
+    if( a_task->get_target_module_id() == abstract_module::get_task_runner_module_id() ||
+        a_task->get_target_module_id() == s_no_module_id )
     {
-        auto runnable_task = std::dynamic_pointer_cast<executable_task>( a_task );
+        auto runnable_task = task_cast<executable_task>( a_task.get() );
         if( runnable_task )
         {
             runnable_task->run_task();
@@ -88,11 +90,17 @@ void module_task_handler::execute( std::shared_ptr<abstract_task> a_task )
         return;
     }
 
-    auto detail_module = framework_manager::get_instance()
-        .get_module_manager().get_module( a_task->get_target_module() );
+    if( s_event_envelope_kind == a_task->get_task_kind() )
+    {
+        framework_manager::get_instance().get_module_manager().schedule_task( std::move( a_task ) );
+        return;
+    }
+
+    std::shared_ptr<abstract_module> detail_module = framework_manager::get_instance()
+        .get_module_manager().get_module_by_id( a_task->get_target_module_id() );
     if( detail_module )
     {
-        detail_module->handle_task( a_task );
+        detail_module->handle_task( std::move( a_task ) );
     }
     else
     {
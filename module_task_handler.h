@@ -25,6 +25,7 @@
 #include <string>
 
 #include "framework_export.h"
+#include "module_id.h"
 
 namespace framework
 {
@@ -55,6 +56,7 @@ private:
     void execute( std::shared_ptr<abstract_task> a_task );
 
     std::string m_task_schedule_helper_module_name;
+    module_id m_task_schedule_helper_module_id = s_no_module_id;
 };
 
 }
@@ -0,0 +1,180 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace framework
+{
+
+/**
+ * Bounded multi-producer multi-consumer queue without lock.
+ * Every cell carries a sequence number which tells producers and consumers
+ * whether the cell is writable or readable at a given position, so a push or
+ * a pop only needs one CAS on the enqueue or dequeue position. The positions
+ * and the cells are cache line aligned to avoid false sharing between threads.
+ * The capacity will be rounded up to a power of two.
+ */
+template<typename T>
+class mpmc_queue
+{
+
+public:
+
+    constexpr static size_t s_cache_line_size = 64;
+
+    explicit mpmc_queue( size_t a_capacity )
+    {
+        size_t capacity = 2;
+        while( capacity < a_capacity )
+        {
+            capacity <<= 1;
+        }
+
+        m_mask = capacity - 1;
+        m_cells = std::make_unique<cell[]>( capacity );
+        for( size_t i = 0; i < capacity; ++i )
+        {
+            m_cells[i].m_sequence.store( i, std::memory_order_relaxed );
+        }
+    }
+
+    mpmc_queue( const mpmc_queue& ) = delete;
+    mpmc_queue& operator=( const mpmc_queue& ) = delete;
+
+    /**
+     * Return false if the queue is full, a_value is untouched in that case.
+     */
+    template<typename U>
+    bool try_push( U&& a_value )
+    {
+        cell* cell_ = nullptr;
+        size_t pos = m_enqueue_pos.m_value.load( std::memory_order_relaxed );
+        while( true )
+        {
+            cell_ = &m_cells[pos & m_mask];
+            size_t seq = cell_->m_sequence.load( std::memory_order_acquire );
+            intptr_t diff = static_cast< intptr_t >( seq ) - static_cast< intptr_t >( pos );
+            if( diff == 0 )
+            {
+                if( m_enqueue_pos.m_value.compare_exchange_weak( pos, pos + 1,
+                    std::memory_order_relaxed ) )
+                {
+                    break;
+                }
+            }
+            else if( diff < 0 )
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_enqueue_pos.m_value.load( std::memory_order_relaxed );
+            }
+        }
+
+        cell_->m_data = std::forward<U>( a_value );
+        cell_->m_sequence.store( pos + 1, std::memory_order_release );
+        return true;
+    }
+
+    /**
+     * Return false if the queue is empty.
+     */
+    bool try_pop( T& a_value )
+    {
+        cell* cell_ = nullptr;
+        size_t pos = m_dequeue_pos.m_value.load( std::memory_order_relaxed );
+        while( true )
+        {
+            cell_ = &m_cells[pos & m_mask];
+            size_t seq = cell_->m_sequence.load( std::memory_order_acquire );
+            intptr_t diff = static_cast< intptr_t >( seq ) - static_cast< intptr_t >( pos + 1 );
+            if( diff == 0 )
+            {
+                if( m_dequeue_pos.m_value.compare_exchange_weak( pos, pos + 1,
+                    std::memory_order_relaxed ) )
+                {
+                    break;
+                }
+            }
+            else if( diff < 0 )
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_dequeue_pos.m_value.load( std::memory_order_relaxed );
+            }
+        }
+
+        a_value = std::move( cell_->m_data );
+        cell_->m_data = T();
+        cell_->m_sequence.store( pos + m_mask + 1, std::memory_order_release );
+        return true;
+    }
+
+    /**
+     * Element count at the time of calling. It may be out of date as soon as
+     * it returns if other threads are pushing or popping.
+     */
+    size_t size_approx()const
+    {
+        size_t enqueue_pos = m_enqueue_pos.m_value.load( std::memory_order_relaxed );
+        size_t dequeue_pos = m_dequeue_pos.m_value.load( std::memory_order_relaxed );
+        return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+    }
+
+    bool empty()const
+    {
+        return size_approx() == 0;
+    }
+
+    size_t capacity()const
+    {
+        return m_mask + 1;
+    }
+
+private:
+
+    struct alignas( s_cache_line_size ) cell
+    {
+        std::atomic_size_t m_sequence{ 0 };
+        T m_data{};
+    };
+
+    struct alignas( s_cache_line_size ) position
+    {
+        std::atomic_size_t m_value{ 0 };
+    };
+
+    position m_enqueue_pos;
+    position m_dequeue_pos;
+    size_t m_mask = 0;
+    std::unique_ptr<cell[]> m_cells;
+};
+
+}
@@ -0,0 +1,42 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "task_kind.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace framework
+{
+
+task_kind task_kind_registry::register_kind( std::string const& a_name )
+{
+    static std::mutex s_mutex;
+    static std::unordered_map<std::string, task_kind> s_kinds;
+
+    // Called once per class, a plain mutex is enough.
+    std::lock_guard<std::mutex> locker( s_mutex );
+    auto [it, inserted] = s_kinds.try_emplace( a_name, s_first_user_task_kind + static_cast<task_kind>( s_kinds.size() ) );
+    return it->second;
+}
+
+}
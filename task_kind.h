@@ -0,0 +1,72 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+
+#include "framework_export.h"
+
+namespace framework
+{
+
+/**
+ * Identifies the concrete class of a task, so dispatching on it is a compare or
+ * a switch instead of a RTTI lookup.
+ */
+using task_kind = uint32_t;
+
+constexpr task_kind s_plain_task_kind = 0; // abstract_task, or a derived one without its own kind
+constexpr task_kind s_executable_task_kind = 1;
+constexpr task_kind s_framework_event_kind = 2;
+constexpr task_kind s_event_envelope_kind = 3;
+constexpr task_kind s_first_user_task_kind = 64; // Kinds given by task_kind_registry start here
+
+/**
+ * Process wide mapping from task class names to kinds. A name keeps its kind
+ * forever, so the kinds are the same in all shared libraries of the process.
+ */
+class FRAMEWORK_EXPORT task_kind_registry
+{
+
+public:
+
+    /**
+     * Return the kind of a_name, give it a new one if a_name is seen first.
+     */
+    static task_kind register_kind( std::string const& a_name );
+};
+
+/**
+ * Kind of derived_task. A task class which wants its own kind calls
+ * set_task_kind( task_kind_of<itself>() ) in its constructors. The name of the
+ * class is looked up only at the first call.
+ */
+template<typename derived_task>
+task_kind task_kind_of()
+{
+    static task_kind const s_kind = task_kind_registry::register_kind( typeid( derived_task ).name() );
+    return s_kind;
+}
+
+}
@@ -0,0 +1,206 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#include "task_pool.h"
+#include "utils.h"
+
+#include <cstdint>
+#include <mutex>
+
+namespace framework
+{
+
+struct free_block
+{
+    free_block* m_next = nullptr;
+    free_block* m_next_batch = nullptr; // Only used by the first block of a batch in the depot
+};
+
+/**
+ * Batches of free blocks shared by all threads, each batch has s_transfer_batch blocks.
+ */
+struct task_block_depot
+{
+    std::mutex m_mutexes[task_memory_pool::s_size_class_count];
+    free_block* m_batches[task_memory_pool::s_size_class_count] = {};
+    uint32_t m_batch_counts[task_memory_pool::s_size_class_count] = {};
+};
+
+static task_block_depot& get_depot()
+{
+    // The thread caches flush into it from thread exit, which can come after exit destroyed the statics.
+    return get_never_destroyed<task_block_depot>();
+}
+
+static void delete_blocks( free_block* a_head )
+{
+    while( a_head )
+    {
+        free_block* block = a_head;
+        a_head = a_head->m_next;
+        ::operator delete( block );
+    }
+}
+
+/**
+ * Move a batch to the depot, or back to the system if the depot is full.
+ */
+static void push_batch( size_t a_size_class, free_block* a_batch )
+{
+    task_block_depot& depot = get_depot();
+    {
+        std::lock_guard<std::mutex> locker( depot.m_mutexes[a_size_class] );
+        if( depot.m_batch_counts[a_size_class] < task_memory_pool::s_max_depot_batches )
+        {
+            a_batch->m_next_batch = depot.m_batches[a_size_class];
+            depot.m_batches[a_size_class] = a_batch;
+            ++depot.m_batch_counts[a_size_class];
+            return;
+        }
+    }
+    delete_blocks( a_batch );
+}
+
+static free_block* pop_batch( size_t a_size_class )
+{
+    task_block_depot& depot = get_depot();
+    std::lock_guard<std::mutex> locker( depot.m_mutexes[a_size_class] );
+    free_block* batch = depot.m_batches[a_size_class];
+    if( batch )
+    {
+        depot.m_batches[a_size_class] = batch->m_next_batch;
+        --depot.m_batch_counts[a_size_class];
+    }
+    return batch;
+}
+
+/**
+ * Cut s_transfer_batch blocks off the front of a_head.
+ */
+static free_block* cut_batch( free_block*& a_head )
+{
+    free_block* batch = a_head;
+    free_block* tail = batch;
+    for( size_t i = 1; i < task_memory_pool::s_transfer_batch; ++i )
+    {
+        tail = tail->m_next;
+    }
+    a_head = tail->m_next;
+    tail->m_next = nullptr;
+    return batch;
+}
+
+/**
+ * Free lists of current thread. Blocks go to the depot when the thread exits.
+ */
+struct task_block_cache
+{
+    ~task_block_cache();
+
+    free_block* m_free_lists[task_memory_pool::s_size_class_count] = {};
+    uint32_t m_free_counts[task_memory_pool::s_size_class_count] = {};
+};
+
+/**
+ * Tasks may still be freed by other thread local objects after the cache is
+ * destroyed, they go to the system directly then.
+ */
+static thread_local bool s_cache_destroyed = false;
+static thread_local task_block_cache s_cache;
+
+task_block_cache::~task_block_cache()
+{
+    s_cache_destroyed = true;
+    for( size_t size_class = 0; size_class < task_memory_pool::s_size_class_count; ++size_class )
+    {
+        free_block*& head = m_free_lists[size_class];
+        for( ; m_free_counts[size_class] >= task_memory_pool::s_transfer_batch;
+            m_free_counts[size_class] -= task_memory_pool::s_transfer_batch )
+        {
+            push_batch( size_class, cut_batch( head ) );
+        }
+        delete_blocks( head );
+        head = nullptr;
+    }
+}
+
+static size_t get_size_class( size_t a_size )
+{
+    return ( a_size - 1 ) / task_memory_pool::s_size_class_step;
+}
+
+void* task_memory_pool::allocate( size_t a_size )
+{
+    if( 0 == a_size || a_size > s_size_class_step * s_size_class_count )
+    {
+        return ::operator new( a_size );
+    }
+
+    size_t size_class = get_size_class( a_size );
+    if( !s_cache_destroyed )
+    {
+        free_block*& head = s_cache.m_free_lists[size_class];
+        if( head )
+        {
+            free_block* block = head;
+            head = block->m_next;
+            --s_cache.m_free_counts[size_class];
+            return block;
+        }
+
+        free_block* batch = pop_batch( size_class );
+        if( batch )
+        {
+            head = batch->m_next;
+            s_cache.m_free_counts[size_class] = static_cast<uint32_t>( s_transfer_batch - 1 );
+            return batch;
+        }
+    }
+    return ::operator new( ( size_class + 1 ) * s_size_class_step );
+}
+
+void task_memory_pool::deallocate( void* a_block, size_t a_size )noexcept
+{
+    if( 0 == a_size || a_size > s_size_class_step * s_size_class_count )
+    {
+        ::operator delete( a_block );
+        return;
+    }
+
+    size_t size_class = get_size_class( a_size );
+    if( s_cache_destroyed )
+    {
+        ::operator delete( a_block );
+        return;
+    }
+
+    free_block* block = ::new( a_block ) free_block;
+    block->m_next = s_cache.m_free_lists[size_class];
+    s_cache.m_free_lists[size_class] = block;
+    if( ++s_cache.m_free_counts[size_class] > s_max_cached_blocks )
+    {
+        push_batch( size_class, cut_batch( s_cache.m_free_lists[size_class] ) );
+        s_cache.m_free_counts[size_class] -= static_cast<uint32_t>( s_transfer_batch );
+    }
+}
+
+}
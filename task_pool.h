@@ -0,0 +1,126 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "framework_export.h"
+
+namespace framework
+{
+
+/**
+ * Recycles the memory of tasks. Each thread keeps a free list per size class, so
+ * allocating and freeing a task mostly takes neither a lock nor malloc. A block
+ * freed in another thread joins the free list of that thread.
+ *
+ * Producers allocate and workers free, so the lists of workers overflow while
+ * producers run dry. An overflowing list moves a batch of blocks to a shared
+ * depot, and a dry one takes a batch back, one lock per batch.
+ */
+class FRAMEWORK_EXPORT task_memory_pool
+{
+
+public:
+
+    constexpr static size_t s_size_class_step = 64;
+    constexpr static size_t s_size_class_count = 8; // Blocks bigger than 512 bytes are not pooled
+    constexpr static size_t s_max_cached_blocks = 256; // Of each size class in each thread
+    constexpr static size_t s_transfer_batch = 64; // Blocks moved between a thread and the depot at once
+    constexpr static size_t s_max_depot_batches = 256; // Of each size class in the depot
+
+    static void* allocate( size_t a_size );
+
+    static void deallocate( void* a_block, size_t a_size )noexcept;
+};
+
+/**
+ * Allocator over task_memory_pool. Over-aligned types bypass the pool.
+ */
+template<typename element_type>
+class task_allocator
+{
+
+public:
+
+    using value_type = element_type;
+
+    task_allocator() noexcept = default;
+
+    template<typename other_type>
+    task_allocator( task_allocator<other_type> const& ) noexcept
+    {
+    }
+
+    element_type* allocate( size_t a_count )
+    {
+        if constexpr( alignof( element_type ) > __STDCPP_DEFAULT_NEW_ALIGNMENT__ )
+        {
+            return static_cast<element_type*>( ::operator new( a_count * sizeof( element_type ),
+                std::align_val_t( alignof( element_type ) ) ) );
+        }
+        else
+        {
+            return static_cast<element_type*>( task_memory_pool::allocate( a_count * sizeof( element_type ) ) );
+        }
+    }
+
+    void deallocate( element_type* a_block, size_t a_count )noexcept
+    {
+        if constexpr( alignof( element_type ) > __STDCPP_DEFAULT_NEW_ALIGNMENT__ )
+        {
+            ::operator delete( a_block, std::align_val_t( alignof( element_type ) ) );
+        }
+        else
+        {
+            task_memory_pool::deallocate( a_block, a_count * sizeof( element_type ) );
+        }
+    }
+
+    template<typename other_type>
+    bool operator==( task_allocator<other_type> const& )const noexcept
+    {
+        return true;
+    }
+
+    template<typename other_type>
+    bool operator!=( task_allocator<other_type> const& )const noexcept
+    {
+        return false;
+    }
+};
+
+/**
+ * Create a task, with the task and its reference count in one pooled block.
+ * Prefer it to std::make_shared for tasks, including user derived ones.
+ */
+template<typename derived_task, typename... arg_types>
+std::shared_ptr<derived_task> make_task( arg_types&&... a_args )
+{
+    return std::allocate_shared<derived_task>( task_allocator<derived_task>(),
+        std::forward<arg_types>( a_args )... );
+}
+
+}
@@ -0,0 +1,126 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/**
+ * A timer callback blocks inside a blocking_guard while the pool is at its
+ * bound. The pool must add a compensation worker once for it and keep it
+ * until the blocking is over, so:
+ * 1. Tasks posted meanwhile still run in time.
+ * 2. The pool does not add and retire compensation workers again and again.
+ * 3. After the blocking, the pool goes back to its bound.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "framework/framework_manager.h"
+#include "framework/blocking_guard.h"
+#include "framework/timer_module.h"
+#include "framework/log_util.h"
+
+constexpr uint32_t s_max_worker_num = 2;
+constexpr uint32_t s_quick_task_count = 200;
+constexpr auto s_blocking_time = std::chrono::milliseconds( 1500 );
+
+std::atomic_bool blocking_started = false;
+std::atomic_bool blocking_done = false;
+
+void blocking_timer( uint32_t a_id, std::string a_name )
+{
+    framework::blocking_guard guard;
+    blocking_started.store( true );
+    std::this_thread::sleep_for( s_blocking_time );
+    blocking_done.store( true );
+}
+
+bool wait_for( std::function<bool()> a_condition, std::chrono::milliseconds a_timeout )
+{
+    auto deadline = std::chrono::steady_clock::now() + a_timeout;
+    while( !a_condition() )
+    {
+        if( std::chrono::steady_clock::now() > deadline )
+        {
+            return false;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    return true;
+}
+
+int main( int argc, char* argv[] )
+{
+    framework::util_logger::set_log_level( framework::log_level::error );
+
+    framework::thread_manager::pool_config config;
+    config.m_min_worker_num = s_max_worker_num;
+    config.m_max_worker_num = s_max_worker_num;
+    config.m_idle_retire_time = std::chrono::milliseconds( 200 );
+    config.m_autoscale_interval = std::chrono::milliseconds( 20 );
+    framework::framework_manager::get_instance().run( nullptr, config );
+    framework::framework_manager::get_instance().power_up();
+
+    auto& thread_manager_ = framework::framework_manager::get_instance().get_thread_manager();
+    auto timer_module_ = std::dynamic_pointer_cast< framework::timer_module >(
+        framework::framework_manager::get_instance().get_module_manager().get_module(
+            framework::timer_module::s_timer_module_name ) );
+    using cb_t = framework::timer_control_block::timeout_callback;
+    timer_module_->register_once_timer( static_cast<cb_t>( std::bind( &blocking_timer,
+        std::placeholders::_1, std::placeholders::_2 ) ), std::chrono::milliseconds( 100 ), "blocking_timer" );
+
+    bool ok = wait_for( []() { return blocking_started.load(); }, std::chrono::seconds( 2 ) );
+    if( !ok )
+    {
+        std::cout << "The blocking timer did not fire.\n";
+    }
+
+    // The blocked timer must not starve the others.
+    std::atomic_uint32_t quick_done = 0;
+    auto start = std::chrono::steady_clock::now();
+    for( uint32_t i = 0; i < s_quick_task_count; ++i )
+    {
+        thread_manager_.post_task( [&quick_done]() { quick_done.fetch_add( 1 ); } );
+    }
+    ok = wait_for( [&quick_done]() { return quick_done.load() == s_quick_task_count; },
+        std::chrono::milliseconds( 500 ) ) && ok;
+    auto quick_time = std::chrono::duration_cast< std::chrono::milliseconds >(
+        std::chrono::steady_clock::now() - start );
+    std::cout << "quick tasks: " << quick_done.load() << "/" << s_quick_task_count << " in "
+        << quick_time.count() << "ms, blocking done: " << blocking_done.load() << std::endl;
+    ok = !blocking_done.load() && ok;
+
+    ok = wait_for( []() { return blocking_done.load(); }, std::chrono::seconds( 5 ) ) && ok;
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+    auto statistics = thread_manager_.get_pool_statistics();
+    std::cout << "workers: " << statistics.m_worker_num << ", blocked: " << statistics.m_blocked_worker_num
+        << ", compensation: " << statistics.m_compensation_count << ", retired: " << statistics.m_retire_count
+        << std::endl;
+
+    // The timer module blocks in turn between timers, so allow a few.
+    ok = statistics.m_compensation_count <= 5 && ok;
+    ok = statistics.m_worker_num <= s_max_worker_num + statistics.m_blocked_worker_num && ok;
+
+    std::cout << ( ok ? "PASS" : "FAIL" ) << std::endl;
+    std::cout << "Test done!\n";
+    return ok ? 0 : 1;
+}
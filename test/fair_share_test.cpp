@@ -0,0 +1,141 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/**
+ * Two sequence modules keep one worker busy, the second one has three times
+ * the weight of the first one. Their CPU time should be about 1:3.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "framework/abstract_module.h"
+#include "framework/framework_manager.h"
+#include "framework/log_util.h"
+
+constexpr uint32_t s_heavy_weight = 3 * framework::s_default_module_weight;
+constexpr auto s_task_cost = std::chrono::microseconds( 200 );
+constexpr auto s_test_time = std::chrono::seconds( 2 );
+constexpr long s_max_backlog = 50;
+
+class busy_module : public framework::abstract_module
+{
+
+public:
+
+    busy_module( std::string a_module_name )
+    {
+        set_name( a_module_name );
+        set_module_type( framework::abstract_module::module_type::sequence_executing );
+    }
+
+    void initialize()
+    {
+        set_power_status( abstract_module::powering_status::power_on );
+    }
+
+    void deinitialize()
+    {
+        set_power_status( abstract_module::powering_status::power_off );
+    }
+
+    void handle_task( std::shared_ptr<framework::abstract_task> a_task )
+    {
+        auto end = std::chrono::steady_clock::now() + s_task_cost;
+        while( std::chrono::steady_clock::now() < end )
+        {
+        }
+        m_done_count.fetch_add( 1 );
+    }
+
+    void handle_event( std::shared_ptr<framework::framework_event> a_event )
+    {
+    }
+
+    std::atomic_long m_done_count = 0;
+};
+
+std::shared_ptr<busy_module> light_module;
+std::shared_ptr<busy_module> heavy_module;
+
+std::vector<std::shared_ptr<framework::abstract_module>> generate_modules()
+{
+    light_module = std::make_shared<busy_module>( "light_module" );
+    heavy_module = std::make_shared<busy_module>( "heavy_module" );
+    return { light_module, heavy_module };
+}
+
+int main( int argc, char* argv[] )
+{
+    framework::util_logger::set_log_level( framework::log_level::error );
+
+    framework::thread_manager::pool_config config;
+    config.m_min_worker_num = 1;
+    config.m_max_worker_num = 1;
+    framework::framework_manager::get_instance().run( std::bind( &generate_modules ), config );
+    framework::framework_manager::get_instance().power_up();
+
+    auto& thread_manager_ = framework::framework_manager::get_instance().get_thread_manager();
+    thread_manager_.set_module_weight( heavy_module->get_name(), s_heavy_weight );
+
+    // Keep both modules backlogged, so they always compete for the worker.
+    std::atomic_bool stop_posting = false;
+    std::thread producer( [&thread_manager_, &stop_posting]()
+        {
+            long posted = 0;
+            while( !stop_posting.load() )
+            {
+                for( auto& module_ : { light_module, heavy_module } )
+                {
+                    auto task = framework::make_task<framework::abstract_task>();
+                    task->set_target_module( module_->get_name() );
+                    thread_manager_.post_task( std::move( task ) );
+                }
+                ++posted;
+
+                while( posted - light_module->m_done_count.load() > s_max_backlog &&
+                    posted - heavy_module->m_done_count.load() > s_max_backlog && !stop_posting.load() )
+                {
+                    std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+                }
+            }
+        } );
+
+    std::this_thread::sleep_for( s_test_time );
+    stop_posting.store( true );
+    producer.join();
+
+    auto light_time = thread_manager_.get_module_cpu_time( light_module->get_name() );
+    auto heavy_time = thread_manager_.get_module_cpu_time( heavy_module->get_name() );
+    double ratio = light_time.count() > 0 ? static_cast< double >( heavy_time.count() ) / light_time.count() : 0;
+    std::cout << "light: " << std::chrono::duration_cast< std::chrono::milliseconds >( light_time ).count()
+        << "ms, heavy: " << std::chrono::duration_cast< std::chrono::milliseconds >( heavy_time ).count()
+        << "ms, ratio: " << ratio << std::endl;
+
+    bool ok = ratio >= 2 && ratio <= 4;
+    std::cout << ( ok ? "PASS" : "FAIL" ) << std::endl;
+    std::cout << "Test done!\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/**
+ * Helpers of the tests which hold the only worker with a gate task, post some
+ * tasks meanwhile, then release it and check how the posted ones executed.
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "framework/abstract_module.h"
+#include "framework/framework_manager.h"
+
+class gated_task : public framework::abstract_task
+{
+
+public:
+
+    gated_task()
+    {
+        set_task_kind( framework::task_kind_of<gated_task>() );
+    }
+
+    bool m_gate = false; // Hold the worker until the gate opens
+    uint32_t m_index = 0;
+};
+
+/**
+ * What a gated_module recorded of an executed task.
+ */
+struct executed_task
+{
+    framework::task_priority m_priority = framework::task_priority::normal;
+    uint32_t m_index = 0;
+};
+
+class gated_module : public framework::abstract_module
+{
+
+public:
+
+    gated_module( std::string a_module_name, module_type a_type )
+    {
+        set_name( a_module_name );
+        set_module_type( a_type );
+    }
+
+    void initialize()
+    {
+        set_power_status( abstract_module::powering_status::power_on );
+    }
+
+    void deinitialize()
+    {
+        set_power_status( abstract_module::powering_status::power_off );
+    }
+
+    void handle_task( std::shared_ptr<framework::abstract_task> a_task )
+    {
+        auto detail_task = framework::task_cast<gated_task>( a_task.get() );
+        if( !detail_task )
+        {
+            return;
+        }
+
+        if( detail_task->m_gate )
+        {
+            s_gate_entered.store( true );
+            while( !s_gate_open.load() )
+            {
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> locker( m_mutex );
+        m_executed.push_back( { detail_task->get_priority(), detail_task->m_index } );
+    }
+
+    void handle_event( std::shared_ptr<framework::framework_event> a_event )
+    {
+    }
+
+    /**
+     * Return the recorded tasks in executed order, and forget them.
+     */
+    std::vector<executed_task> take_executed()
+    {
+        std::lock_guard<std::mutex> locker( m_mutex );
+        return std::move( m_executed );
+    }
+
+    size_t executed_count()
+    {
+        std::lock_guard<std::mutex> locker( m_mutex );
+        return m_executed.size();
+    }
+
+    inline static std::atomic_bool s_gate_entered = false;
+    inline static std::atomic_bool s_gate_open = false;
+
+private:
+
+    std::mutex m_mutex;
+    std::vector<executed_task> m_executed;
+};
+
+/**
+ * A sequence executing one and a concurrently executing one.
+ */
+inline std::shared_ptr<gated_module> gated_sequence_module;
+inline std::shared_ptr<gated_module> gated_concurrent_module;
+
+inline std::vector<std::shared_ptr<framework::abstract_module>> generate_gated_modules()
+{
+    gated_sequence_module = std::make_shared<gated_module>( "gated_sequence_module",
+        framework::abstract_module::module_type::sequence_executing );
+    gated_concurrent_module = std::make_shared<gated_module>( "gated_concurrent_module",
+        framework::abstract_module::module_type::concurrently_executing );
+    return { gated_sequence_module, gated_concurrent_module };
+}
+
+/**
+ * Run the framework with the gated modules and only one worker.
+ */
+inline void run_with_one_worker()
+{
+    framework::thread_manager::pool_config config;
+    config.m_min_worker_num = 1;
+    config.m_max_worker_num = 1;
+    framework::framework_manager::get_instance().run( &generate_gated_modules, config );
+    framework::framework_manager::get_instance().power_up();
+}
+
+inline std::shared_ptr<gated_task> make_gated_task( std::shared_ptr<gated_module> const& a_module, uint32_t a_index = 0 )
+{
+    auto task = framework::make_task<gated_task>();
+    task->set_target_module( a_module->get_name() );
+    task->m_index = a_index;
+    return task;
+}
+
+inline void post_gated_task( std::shared_ptr<gated_task> a_task )
+{
+    framework::framework_manager::get_instance().get_thread_manager().post_task( std::move( a_task ) );
+}
+
+inline bool wait_for( std::function<bool()> a_condition, std::chrono::milliseconds a_timeout )
+{
+    auto deadline = std::chrono::steady_clock::now() + a_timeout;
+    while( !a_condition() )
+    {
+        if( std::chrono::steady_clock::now() > deadline )
+        {
+            return false;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    return true;
+}
+
+/**
+ * Hold the only worker with a gate task of a_module, call a_posts meanwhile, keep
+ * holding it for a_hold_time, then release it. Return the tasks in executed order
+ * once a_expected ones executed, or after a timeout.
+ */
+inline std::vector<executed_task> run_gated
+    (
+    std::shared_ptr<gated_module> const& a_module,
+    std::function<void()> a_posts,
+    size_t a_expected,
+    std::chrono::milliseconds a_hold_time = std::chrono::milliseconds( 0 )
+    )
+{
+    gated_module::s_gate_entered.store( false );
+    gated_module::s_gate_open.store( false );
+    auto gate = make_gated_task( a_module );
+    gate->m_gate = true;
+    post_gated_task( std::move( gate ) );
+    wait_for( []() { return gated_module::s_gate_entered.load(); }, std::chrono::seconds( 2 ) );
+
+    a_posts();
+    std::this_thread::sleep_for( a_hold_time );
+    gated_module::s_gate_open.store( true );
+    wait_for( [&a_module, a_expected]() { return a_module->executed_count() >= a_expected; },
+        std::chrono::seconds( 10 ) );
+    return a_module->take_executed();
+}
@@ -0,0 +1,152 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/**
+ * Throughput benchmark of the concurrently executing task path.
+ * 1. Raw mpmc_queue: N producers and N consumers move a fixed amount of
+ *    items through one queue.
+ * 2. thread_manager::post_task: N producers post a fixed amount of tasks to
+ *    task_runner_module, which is a concurrently executing module.
+ * Both print items per second for each producer count, which should scale
+ * with producer count instead of collapsing on a lock.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "framework/framework_manager.h"
+#include "framework/log_util.h"
+#include "framework/mpmc_queue.h"
+
+constexpr uint32_t s_items_per_producer = 200000;
+constexpr uint32_t s_tasks_per_producer = 50000;
+
+double benchmark_queue( uint32_t a_producer_count )
+{
+    framework::mpmc_queue<uint64_t> queue( 4096 );
+    std::atomic_uint64_t consumed = 0;
+    uint64_t total = static_cast< uint64_t >( a_producer_count ) * s_items_per_producer;
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for( uint32_t i = 0; i < a_producer_count; ++i )
+    {
+        threads.emplace_back( [&queue]()
+            {
+                for( uint64_t j = 0; j < s_items_per_producer; ++j )
+                {
+                    while( !queue.try_push( j ) )
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            } );
+        threads.emplace_back( [&queue, &consumed, total]()
+            {
+                uint64_t value = 0;
+                while( consumed.load( std::memory_order_relaxed ) < total )
+                {
+                    if( queue.try_pop( value ) )
+                    {
+                        consumed.fetch_add( 1, std::memory_order_relaxed );
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            } );
+    }
+
+    for( auto& ele : threads )
+    {
+        ele.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return total / elapsed.count();
+}
+
+std::pair<double, double> benchmark_post_task( uint32_t a_producer_count )
+{
+    std::atomic_uint64_t executed = 0;
+    uint64_t total = static_cast< uint64_t >( a_producer_count ) * s_tasks_per_producer;
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for( uint32_t i = 0; i < a_producer_count; ++i )
+    {
+        threads.emplace_back( [&executed]()
+            {
+                auto& manager = framework::framework_manager::get_instance().get_thread_manager();
+                for( uint32_t j = 0; j < s_tasks_per_producer; ++j )
+                {
+                    manager.post_task( [&executed]()
+                        {
+                            executed.fetch_add( 1, std::memory_order_relaxed );
+                        } );
+                }
+            } );
+    }
+
+    for( auto& ele : threads )
+    {
+        ele.join();
+    }
+    std::chrono::duration<double> post_elapsed = std::chrono::steady_clock::now() - start;
+
+    while( executed.load() < total )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    std::chrono::duration<double> run_elapsed = std::chrono::steady_clock::now() - start;
+
+    return { total / post_elapsed.count(), total / run_elapsed.count() };
+}
+
+int main( int argc, char* argv[] )
+{
+    framework::util_logger::set_log_level( framework::log_level::warning );
+
+    std::cout << "mpmc_queue, producers == consumers\n";
+    for( uint32_t producers = 1; producers <= 8; producers <<= 1 )
+    {
+        std::cout << "  producers: " << producers << ", items/s: "
+            << static_cast< uint64_t >( benchmark_queue( producers ) ) << "\n";
+    }
+
+    framework::framework_manager::get_instance().run( nullptr );
+    framework::framework_manager::get_instance().power_up();
+
+    std::cout << "thread_manager::post_task to " << framework::abstract_module::s_task_runner_module_name << "\n";
+    for( uint32_t producers = 1; producers <= 8; producers <<= 1 )
+    {
+        auto [post_rate, run_rate] = benchmark_post_task( producers );
+        std::cout << "  producers: " << producers << ", posted/s: " << static_cast< uint64_t >( post_rate )
+            << ", executed/s: " << static_cast< uint64_t >( run_rate ) << "\n";
+    }
+
+    std::cout << "Test done!\n";
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/**
+ * Run and stop the framework again and again, while a producer keeps posting.
+ * 1. stop drains the queued tasks of sequence and dedicated thread modules,
+ *    then leaves no worker.
+ * 2. A task whose post_task started before stop returned never executes
+ *    after the next run.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "framework/abstract_module.h"
+#include "framework/framework_manager.h"
+#include "framework/timer_module.h"
+#include "framework/log_util.h"
+
+constexpr uint32_t s_restart_count = 5;
+constexpr uint32_t s_task_count = 20000;
+constexpr auto s_stop_timeout = std::chrono::milliseconds( 1000 );
+
+std::atomic_uint32_t generation = 0; // Raised after each stop returned
+std::atomic_uint64_t executed_count = 0;
+std::atomic_uint64_t stale_count = 0;
+
+class restart_task : public framework::abstract_task
+{
+
+public:
+
+    uint32_t m_generation = 0; // generation when post_task started
+    bool m_counted = false; // Posted by main, counted in executed_count
+};
+
+class restart_module : public framework::abstract_module
+{
+
+public:
+
+    restart_module( std::string a_module_name, module_type a_type )
+    {
+        set_name( a_module_name );
+        set_module_type( a_type );
+    }
+
+    void initialize()
+    {
+        set_power_status( abstract_module::powering_status::power_on );
+    }
+
+    void deinitialize()
+    {
+        set_power_status( abstract_module::powering_status::power_off );
+    }
+
+    void handle_task( std::shared_ptr<framework::abstract_task> a_task )
+    {
+        auto detail_task = std::dynamic_pointer_cast<restart_task>( a_task );
+        if( !detail_task )
+        {
+            return;
+        }
+
+        if( detail_task->m_generation != generation.load() )
+        {
+            stale_count.fetch_add( 1 );
+        }
+
+        if( detail_task->m_counted )
+        {
+            executed_count.fetch_add( 1 );
+        }
+    }
+
+    void handle_event( std::shared_ptr<framework::framework_event> a_event )
+    {
+    }
+};
+
+const char* s_sequence_module_name = "restart_sequence_module";
+const char* s_dedicated_module_name = "restart_dedicated_module";
+
+std::vector<std::shared_ptr<framework::abstract_module>> generate_modules()
+{
+    return {
+        std::make_shared<restart_module>( s_sequence_module_name,
+            framework::abstract_module::module_type::sequence_executing ),
+        std::make_shared<restart_module>( s_dedicated_module_name,
+            framework::abstract_module::module_type::dedicated_thread ) };
+}
+
+void post_restart_task( std::string const& a_module, bool a_counted )
+{
+    auto task = framework::make_task<restart_task>();
+    task->set_target_module( a_module );
+    task->m_generation = generation.load();
+    task->m_counted = a_counted;
+    framework::framework_manager::get_instance().get_thread_manager().post_task( std::move( task ) );
+}
+
+int main( int argc, char* argv[] )
+{
+    framework::util_logger::set_log_level( framework::log_level::error );
+    auto& framework_manager_ = framework::framework_manager::get_instance();
+
+    // Races each stop, its tasks posted just before stop must not leak into the next run.
+    std::atomic_bool quit = false;
+    std::thread producer( [&quit]()
+        {
+            while( !quit.load() )
+            {
+                post_restart_task( s_sequence_module_name, false );
+                post_restart_task( s_dedicated_module_name, false );
+            }
+        } );
+
+    bool ok = true;
+    for( uint32_t i = 0; i < s_restart_count; ++i )
+    {
+        executed_count.store( 0 );
+        framework_manager_.run( std::bind( &generate_modules ) );
+        framework_manager_.power_up();
+
+        std::atomic_uint32_t timer_hits = 0;
+        auto timer_module_ = framework_manager_.get_module_manager().get_module<framework::timer_module>(
+            framework::abstract_module::s_timer_module_name );
+        timer_module_->register_timer( std::function<void()>( [&timer_hits]() { timer_hits.fetch_add( 1 ); } ),
+            std::chrono::milliseconds( 5 ) );
+
+        for( uint32_t j = 0; j < s_task_count; ++j )
+        {
+            post_restart_task( j % 2 ? s_sequence_module_name : s_dedicated_module_name, true );
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+
+        auto stop_start = std::chrono::steady_clock::now();
+        framework_manager_.stop( s_stop_timeout );
+        auto stop_time = std::chrono::duration_cast< std::chrono::milliseconds >(
+            std::chrono::steady_clock::now() - stop_start );
+        generation.fetch_add( 1 );
+
+        auto statistics = framework_manager_.get_thread_manager().get_pool_statistics();
+        std::cout << "run " << i << ", executed: " << executed_count.load() << "/" << s_task_count
+            << ", timer hits: " << timer_hits.load() << ", workers: " << statistics.m_worker_num
+            << ", stop: " << stop_time.count() << "ms" << std::endl;
+        ok = executed_count.load() == s_task_count && timer_hits.load() > 0 && statistics.m_worker_num == 0 &&
+            !framework_manager_.is_running() && ok;
+    }
+
+    quit.store( true );
+    producer.join();
+
+    std::cout << "stale tasks executed: " << stale_count.load() << std::endl;
+    ok = stale_count.load() == 0 && ok;
+    std::cout << ( ok ? "PASS" : "FAIL" ) << std::endl;
+    std::cout << "Test done!\n";
+    return ok ? 0 : 1;
+}
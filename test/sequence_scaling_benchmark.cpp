@@ -0,0 +1,187 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/**
+ * Throughput of posting to sequence executing modules.
+ * N producers post a fixed amount of tasks, spread over 20 sequence modules.
+ * Posting to one module does not contend with posting to another, so posted
+ * per second should scale with producer count, as long as there are CPUs.
+ * Each module also checks the tasks of a producer come in the posted order.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "framework/abstract_module.h"
+#include "framework/framework_manager.h"
+#include "framework/log_util.h"
+
+constexpr uint32_t s_module_count = 20;
+constexpr uint32_t s_max_producer_count = 8;
+constexpr uint32_t s_tasks_per_producer = 50000;
+
+std::atomic_uint64_t executed_count = 0;
+std::atomic_uint64_t disorder_count = 0;
+
+class sequence_scaling_task : public framework::abstract_task
+{
+
+public:
+
+    uint32_t m_producer = 0;
+    uint32_t m_sequence = 0;
+};
+
+class sequence_scaling_module : public framework::abstract_module
+{
+
+public:
+
+    sequence_scaling_module( std::string a_module_name )
+    {
+        set_name( a_module_name );
+        set_module_type( framework::abstract_module::module_type::sequence_executing );
+    }
+
+    void initialize()
+    {
+        set_power_status( abstract_module::powering_status::power_on );
+    }
+
+    void deinitialize()
+    {
+        set_power_status( abstract_module::powering_status::power_off );
+    }
+
+    /**
+     * A sequence module runs one task at a time, no lock is needed for m_next_sequence.
+     */
+    void handle_task( std::shared_ptr<framework::abstract_task> a_task )
+    {
+        auto detail_task = std::dynamic_pointer_cast<sequence_scaling_task>( a_task );
+        if( !detail_task )
+        {
+            return;
+        }
+
+        uint32_t& next_sequence = m_next_sequence[detail_task->m_producer];
+        if( detail_task->m_sequence < next_sequence )
+        {
+            disorder_count.fetch_add( 1, std::memory_order_relaxed );
+        }
+        next_sequence = detail_task->m_sequence + 1;
+        executed_count.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    void handle_event( std::shared_ptr<framework::framework_event> a_event )
+    {
+    }
+
+    void reset()
+    {
+        std::fill( std::begin( m_next_sequence ), std::end( m_next_sequence ), 0 );
+    }
+
+private:
+
+    uint32_t m_next_sequence[s_max_producer_count] = {};
+};
+
+std::vector<std::shared_ptr<sequence_scaling_module>> scaling_modules;
+
+std::vector<std::shared_ptr<framework::abstract_module>> generate_modules()
+{
+    std::vector<std::shared_ptr<framework::abstract_module>> modules;
+    for( uint32_t i = 0; i < s_module_count; ++i )
+    {
+        auto module_ = std::make_shared<sequence_scaling_module>( "sequence_scaling_module_" + std::to_string( i ) );
+        scaling_modules.push_back( module_ );
+        modules.push_back( std::move( module_ ) );
+    }
+    return modules;
+}
+
+void benchmark_sequence_modules( uint32_t a_producer_count )
+{
+    auto& thread_manager_ = framework::framework_manager::get_instance().get_thread_manager();
+    uint64_t total = static_cast< uint64_t >( a_producer_count ) * s_tasks_per_producer;
+    executed_count.store( 0 );
+    for( auto& module_ : scaling_modules )
+    {
+        module_->reset();
+    }
+
+    std::vector<std::thread> producers;
+    auto start = std::chrono::steady_clock::now();
+    for( uint32_t i = 0; i < a_producer_count; ++i )
+    {
+        producers.emplace_back( [&thread_manager_, i]()
+            {
+                for( uint32_t j = 0; j < s_tasks_per_producer; ++j )
+                {
+                    auto task = framework::make_task<sequence_scaling_task>();
+                    task->set_target_module( scaling_modules[( i + j ) % s_module_count]->get_name() );
+                    task->m_producer = i;
+                    task->m_sequence = j;
+                    thread_manager_.post_task( std::move( task ) );
+                }
+            } );
+    }
+
+    for( auto& producer : producers )
+    {
+        producer.join();
+    }
+    auto posted = std::chrono::steady_clock::now();
+
+    while( executed_count.load() < total )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    auto executed = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> post_seconds = posted - start;
+    std::chrono::duration<double> execute_seconds = executed - start;
+    std::cout << "  producers: " << a_producer_count
+        << ", posted/s: " << static_cast< uint64_t >( total / post_seconds.count() )
+        << ", executed/s: " << static_cast< uint64_t >( total / execute_seconds.count() ) << std::endl;
+}
+
+int main( int argc, char* argv[] )
+{
+    framework::util_logger::set_log_level( framework::log_level::error );
+    framework::framework_manager::get_instance().run( std::bind( &generate_modules ) );
+    framework::framework_manager::get_instance().power_up();
+
+    std::cout << "thread_manager::post_task to " << s_module_count << " sequence modules:" << std::endl;
+    for( uint32_t producer_count = 1; producer_count <= s_max_producer_count; producer_count *= 2 )
+    {
+        benchmark_sequence_modules( producer_count );
+    }
+
+    std::cout << "tasks out of order: " << disorder_count.load() << std::endl;
+    std::cout << "Test done!\n";
+    return disorder_count.load() == 0 ? 0 : 1;
+}
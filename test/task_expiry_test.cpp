@@ -0,0 +1,134 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/**
+ * Task expiry and deadlines with one worker. While the worker is held:
+ * 1. Tasks expired before a worker took them are dropped and counted to
+ *    their module, for both concurrently and sequence executing modules.
+ * 2. Concurrently executing tasks with a deadline run earliest deadline
+ *    first, before the ones without deadline.
+ */
+
+#include <algorithm>
+#include <iostream>
+
+#include "framework/log_util.h"
+#include "gated_module_test.h"
+
+constexpr uint32_t s_expiring_task_count = 50;
+constexpr uint32_t s_lasting_task_count = 50;
+constexpr uint32_t s_deadline_task_count = 10;
+constexpr auto s_expiry_time = std::chrono::milliseconds( 20 );
+
+/**
+ * Index [0, s_expiring_task_count) expire, the others do not.
+ */
+void post_expiring_tasks( std::shared_ptr<gated_module> const& a_module )
+{
+    auto expiry_time = std::chrono::steady_clock::now() + s_expiry_time;
+    for( uint32_t i = 0; i < s_expiring_task_count + s_lasting_task_count; ++i )
+    {
+        auto task = make_gated_task( a_module, i );
+        if( i < s_expiring_task_count )
+        {
+            task->set_expiry_time( expiry_time );
+        }
+        post_gated_task( std::move( task ) );
+    }
+}
+
+/**
+ * Hold the worker until the expiring ones expired, and give a wrongly kept one
+ * the chance to run after the expected ones.
+ */
+std::vector<executed_task> run_expiring( std::shared_ptr<gated_module> const& a_module,
+    std::function<void()> a_posts, size_t a_expected )
+{
+    auto executed = run_gated( a_module, std::move( a_posts ), a_expected, 3 * s_expiry_time );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    for( auto& ele : a_module->take_executed() )
+    {
+        executed.push_back( ele );
+    }
+    return executed;
+}
+
+bool check_expired( std::shared_ptr<gated_module> const& a_module, std::vector<executed_task> const& a_executed )
+{
+    auto& thread_manager_ = framework::framework_manager::get_instance().get_thread_manager();
+    uint64_t expired_count = thread_manager_.get_expired_task_count( a_module->get_name() );
+    bool ran_expired = std::any_of( a_executed.begin(), a_executed.end(),
+        []( executed_task const& a_task ) { return a_task.m_index < s_expiring_task_count; } );
+
+    std::cout << a_module->get_name() << ", executed: " << a_executed.size() << ", expired: " << expired_count
+        << ", ran an expired one: " << ( ran_expired ? "yes" : "no" ) << std::endl;
+    return !ran_expired && expired_count == s_expiring_task_count;
+}
+
+bool test_sequence_module()
+{
+    auto executed = run_expiring( gated_sequence_module, []() { post_expiring_tasks( gated_sequence_module ); },
+        s_lasting_task_count );
+    return check_expired( gated_sequence_module, executed ) && executed.size() == s_lasting_task_count;
+}
+
+bool test_concurrent_module()
+{
+    constexpr uint32_t first_deadline_index = s_expiring_task_count + s_lasting_task_count;
+    auto executed = run_expiring( gated_concurrent_module, []()
+        {
+            post_expiring_tasks( gated_concurrent_module );
+
+            // Later posted ones have earlier deadlines.
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 1 );
+            for( uint32_t i = 0; i < s_deadline_task_count; ++i )
+            {
+                auto task = make_gated_task( gated_concurrent_module, first_deadline_index + i );
+                task->set_deadline( deadline - std::chrono::milliseconds( i ) );
+                post_gated_task( std::move( task ) );
+            }
+        }, s_lasting_task_count + s_deadline_task_count );
+
+    bool ok = check_expired( gated_concurrent_module, executed ) &&
+        executed.size() == s_lasting_task_count + s_deadline_task_count;
+
+    bool deadline_first = executed.size() >= s_deadline_task_count;
+    for( uint32_t i = 0; i < s_deadline_task_count && deadline_first; ++i )
+    {
+        deadline_first = executed[i].m_index == first_deadline_index + s_deadline_task_count - 1 - i;
+    }
+    std::cout << "earliest deadline first: " << ( deadline_first ? "yes" : "no" ) << std::endl;
+    return ok && deadline_first;
+}
+
+int main( int argc, char* argv[] )
+{
+    framework::util_logger::set_log_level( framework::log_level::error );
+    run_with_one_worker();
+
+    bool ok = test_sequence_module();
+    ok = test_concurrent_module() && ok;
+
+    std::cout << ( ok ? "PASS" : "FAIL" ) << std::endl;
+    std::cout << "Test done!\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/**
+ * Tasks derived from executable_task or framework_event with their own kind:
+ * 1. task_cast matches them as their base class, and tells apart unrelated kinds.
+ * 2. They are run or delivered as their base class when posted, to the task
+ *    runner and to a module.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "framework/abstract_module.h"
+#include "framework/executable_task.h"
+#include "framework/framework_event.h"
+#include "framework/framework_manager.h"
+#include "framework/log_util.h"
+
+class counted_task : public framework::executable_task
+{
+
+public:
+
+    counted_task( framework::unique_function<bool()> a_fun )
+        : executable_task( std::move( a_fun ) )
+    {
+        set_task_kind( framework::task_kind_of<counted_task>() );
+    }
+
+    counted_task()
+    {
+        set_task_kind( framework::task_kind_of<counted_task>() );
+    }
+};
+
+class counted_event : public framework::framework_event
+{
+
+public:
+
+    counted_event()
+    {
+        set_task_kind( framework::task_kind_of<counted_event>() );
+        m_event_type = framework::event_type::derived_type;
+    }
+};
+
+class plain_task : public framework::abstract_task
+{
+
+public:
+
+    plain_task()
+    {
+        set_task_kind( framework::task_kind_of<plain_task>() );
+    }
+};
+
+std::atomic_uint32_t runner_count = 0;
+std::atomic_uint32_t module_task_count = 0;
+std::atomic_uint32_t module_event_count = 0;
+
+class kind_module : public framework::abstract_module
+{
+
+public:
+
+    kind_module( std::string a_module_name )
+    {
+        set_name( a_module_name );
+        set_module_type( framework::abstract_module::module_type::concurrently_executing );
+    }
+
+    void initialize()
+    {
+        set_power_status( abstract_module::powering_status::power_on );
+    }
+
+    void deinitialize()
+    {
+        set_power_status( abstract_module::powering_status::power_off );
+    }
+
+    void handle_task( std::shared_ptr<framework::abstract_task> a_task )
+    {
+    }
+
+    void handle_event( std::shared_ptr<framework::framework_event> a_event )
+    {
+        if( framework::task_cast<counted_event>( a_event ) )
+        {
+            module_event_count.fetch_add( 1 );
+        }
+    }
+};
+
+const char* s_kind_module_name = "kind_module";
+
+std::vector<std::shared_ptr<framework::abstract_module>> generate_modules()
+{
+    return { std::make_shared<kind_module>( s_kind_module_name ) };
+}
+
+bool test_task_cast()
+{
+    std::shared_ptr<framework::abstract_task> counted = framework::make_task<counted_task>( []() { return false; } );
+    std::shared_ptr<framework::abstract_task> event_ = framework::make_task<counted_event>();
+    std::shared_ptr<framework::abstract_task> plain = framework::make_task<plain_task>();
+
+    bool ok = counted->get_task_kind() >= framework::s_first_user_task_kind &&
+        counted->get_task_kind() != event_->get_task_kind() &&
+        framework::task_cast<counted_task>( counted ) && framework::task_cast<framework::executable_task>( counted ) &&
+        framework::task_cast<counted_event>( event_ ) && framework::task_cast<framework::framework_event>( event_ ) &&
+        !framework::task_cast<framework::executable_task>( event_ ) &&
+        !framework::task_cast<framework::framework_event>( counted ) &&
+        !framework::task_cast<framework::executable_task>( plain ) && !framework::task_cast<counted_task>( plain );
+    std::cout << "task_cast of derived kinds: " << ( ok ? "ok" : "wrong" ) << std::endl;
+    return ok;
+}
+
+bool wait_for( std::function<bool()> a_condition, std::chrono::milliseconds a_timeout )
+{
+    auto deadline = std::chrono::steady_clock::now() + a_timeout;
+    while( !a_condition() )
+    {
+        if( std::chrono::steady_clock::now() > deadline )
+        {
+            return false;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    return true;
+}
+
+int main( int argc, char* argv[] )
+{
+    framework::util_logger::set_log_level( framework::log_level::error );
+    bool ok = test_task_cast();
+
+    framework::framework_manager::get_instance().run( std::bind( &generate_modules ) );
+    framework::framework_manager::get_instance().power_up();
+    auto& thread_manager_ = framework::framework_manager::get_instance().get_thread_manager();
+
+    // Runs on the task runner module.
+    thread_manager_.post_task( framework::make_task<counted_task>( []()
+        {
+            runner_count.fetch_add( 1 );
+            return false;
+        } ) );
+
+    // Goes through the module manager to a module.
+    auto module_task = framework::make_task<counted_task>();
+    module_task->set_fun( []() { module_task_count.fetch_add( 1 ); }, s_kind_module_name );
+    thread_manager_.post_task( std::move( module_task ) );
+
+    auto event_ = framework::make_task<counted_event>();
+    event_->set_target_module( s_kind_module_name );
+    thread_manager_.post_task( std::move( event_ ) );
+
+    ok = wait_for( []() { return runner_count.load() == 1 && module_task_count.load() == 1 &&
+        module_event_count.load() == 1; }, std::chrono::seconds( 2 ) ) && ok;
+    std::cout << "runner: " << runner_count.load() << ", module task: " << module_task_count.load()
+        << ", module event: " << module_event_count.load() << std::endl;
+
+    std::cout << ( ok ? "PASS" : "FAIL" ) << std::endl;
+    std::cout << "Test done!\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+/**
+ * Priority lanes with one worker:
+ * 1. A sequence module runs its pending high priority tasks before the
+ *    background ones posted earlier.
+ * 2. Concurrently executing tasks: high priority tasks go first, but a flood
+ *    of them does not starve the background ones.
+ */
+
+#include <iostream>
+
+#include "framework/log_util.h"
+#include "gated_module_test.h"
+
+constexpr uint32_t s_background_task_count = 100;
+constexpr uint32_t s_high_task_count = 400;
+
+void post_priority_tasks( std::shared_ptr<gated_module> const& a_module, framework::task_priority a_priority,
+    uint32_t a_count )
+{
+    for( uint32_t i = 0; i < a_count; ++i )
+    {
+        auto task = make_gated_task( a_module, i );
+        task->set_priority( a_priority );
+        post_gated_task( std::move( task ) );
+    }
+}
+
+bool test_sequence_module()
+{
+    auto executed = run_gated( gated_sequence_module, []()
+        {
+            post_priority_tasks( gated_sequence_module, framework::task_priority::background, s_background_task_count );
+            post_priority_tasks( gated_sequence_module, framework::task_priority::high, s_background_task_count );
+        }, 2 * s_background_task_count );
+
+    bool ok = executed.size() == 2 * s_background_task_count;
+    for( size_t i = 0; i < executed.size() && ok; ++i )
+    {
+        ok = executed[i].m_priority == ( i < s_background_task_count ? framework::task_priority::high :
+            framework::task_priority::background );
+    }
+    std::cout << "sequence module, high ones first: " << ( ok ? "yes" : "no" ) << std::endl;
+    return ok;
+}
+
+bool test_concurrent_module()
+{
+    auto executed = run_gated( gated_concurrent_module, []()
+        {
+            post_priority_tasks( gated_concurrent_module, framework::task_priority::background, s_background_task_count );
+            post_priority_tasks( gated_concurrent_module, framework::task_priority::high, s_high_task_count );
+        }, s_background_task_count + s_high_task_count );
+
+    // How many background tasks ran while high ones were still waiting.
+    size_t last_high = 0;
+    for( size_t i = 0; i < executed.size(); ++i )
+    {
+        if( executed[i].m_priority == framework::task_priority::high )
+        {
+            last_high = i;
+        }
+    }
+    size_t background_before_last_high = last_high + 1 - s_high_task_count;
+
+    std::cout << "concurrent module, executed: " << executed.size() << ", background ones ran amid the high flood: "
+        << background_before_last_high << std::endl;
+
+    // High ones are preferred, the background ones still progress.
+    return executed.size() == s_background_task_count + s_high_task_count &&
+        background_before_last_high > 0 && background_before_last_high < s_background_task_count;
+}
+
+int main( int argc, char* argv[] )
+{
+    framework::util_logger::set_log_level( framework::log_level::error );
+    run_with_one_worker();
+
+    bool ok = test_sequence_module();
+    ok = test_concurrent_module() && ok;
+
+    std::cout << ( ok ? "PASS" : "FAIL" ) << std::endl;
+    std::cout << "Test done!\n";
+    return ok ? 0 : 1;
+}
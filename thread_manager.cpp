@@ -28,24 +28,208 @@
 #include "thread_worker.h"
 #include "log_util.h"
 #include "executable_task.h"
+#include "framework_event.h"
+#include "internal/platform.h"
+
+#include <algorithm>
+#include <thread>
 
 namespace framework
 {
 
-static thread_local std::string s_thread_module_owner;
+static thread_local module_id s_thread_module_owner = s_no_module_id;
+static thread_local abstract_worker* s_current_worker = nullptr;
+static thread_local uint32_t s_blocking_depth = 0; // Nested blocking_guard of current worker
+static thread_local uint32_t s_next_steal_victim = 0;
+static thread_local uint32_t s_backlog_pop_count = 0;
+
+/**
+ * Heap order of the deadline backlog, the earliest deadline at front.
+ */
+static bool later_deadline
+    (
+    std::shared_ptr<abstract_task> const& a_left,
+    std::shared_ptr<abstract_task> const& a_right
+    )
+{
+    return a_left->get_deadline() > a_right->get_deadline();
+}
+
+static int64_t steady_now()
+{
+    return std::chrono::duration_cast< std::chrono::nanoseconds >(
+        std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
 
 std::string const& thread_manager::get_current_thread_module_owner()
 {
-    return s_thread_module_owner;
+    return module_name_registry::get_name( s_thread_module_owner );
+}
+
+void thread_manager::set_current_thread_module_owner( module_id a_module )
+{
+    s_thread_module_owner = a_module;
+}
+
+abstract_worker* thread_manager::get_current_worker()
+{
+    return s_current_worker;
+}
+
+void thread_manager::set_current_worker( abstract_worker* a_worker )
+{
+    s_current_worker = a_worker;
+}
+
+thread_manager::thread_manager()
+{
+    std::vector<std::vector<uint32_t>> nodes = get_numa_nodes();
+    for( size_t node = 0; node < nodes.size(); ++node )
+    {
+        for( uint32_t cpu : nodes[node] )
+        {
+            if( m_cpu_numa_node.size() <= cpu )
+            {
+                m_cpu_numa_node.resize( cpu + 1, 0 );
+            }
+            m_cpu_numa_node[cpu] = static_cast< int32_t >( node );
+        }
+        m_numa_nodes.emplace_back( std::make_unique<numa_node>() );
+        m_numa_nodes.back()->m_cpus = std::move( nodes[node] );
+    }
+    LogUtilInfo() << "numa node count: " << m_numa_nodes.size();
+
+    set_pool_config( pool_config{} );
+}
+
+void thread_manager::set_pool_config( pool_config const& a_config )
+{
+    uint32_t min_worker_num = a_config.m_min_worker_num;
+    if( 0 == min_worker_num )
+    {
+        min_worker_num = s_default_min_worker_num;
+    }
+
+    uint32_t max_worker_num = a_config.m_max_worker_num;
+    if( 0 == max_worker_num )
+    {
+        max_worker_num = std::max( { std::thread::hardware_concurrency(), s_default_max_worker_num, min_worker_num } );
+    }
+    else if( max_worker_num < min_worker_num )
+    {
+        LogUtilWarning() << "max worker number " << max_worker_num << " is less than min worker number "
+            << min_worker_num << ", use the min one.";
+        max_worker_num = min_worker_num;
+    }
+
+    std::chrono::nanoseconds max_task_wait_time = a_config.m_max_task_wait_time;
+    if( max_task_wait_time.count() <= 0 )
+    {
+        max_task_wait_time = std::chrono::milliseconds( s_max_task_time_out );
+    }
+
+    std::chrono::nanoseconds idle_retire_time = a_config.m_idle_retire_time;
+    if( idle_retire_time.count() <= 0 )
+    {
+        idle_retire_time = s_default_idle_retire_time;
+    }
+
+    std::chrono::milliseconds autoscale_interval = a_config.m_autoscale_interval;
+    if( autoscale_interval.count() <= 0 )
+    {
+        autoscale_interval = s_default_autoscale_interval;
+    }
+
+    m_min_worker_num.store( min_worker_num );
+    m_max_worker_num.store( max_worker_num );
+    m_max_task_wait_time.store( max_task_wait_time.count() );
+    m_idle_retire_time.store( idle_retire_time.count() );
+    m_autoscale_interval.store( std::chrono::nanoseconds( autoscale_interval ).count() );
+    LogUtilInfo() << "worker pool size: " << min_worker_num << " - " << max_worker_num;
+
+    {
+        std::lock_guard<std::recursive_mutex> locker( m_mutex );
+        m_worker_cpus = a_config.m_worker_cpus;
+        m_pin_each_worker = a_config.m_pin_each_worker && !m_worker_cpus.empty();
+    }
+
+    uint32_t timer_id = m_schedule_timer_id.load();
+    if( 0 != timer_id )
+    {
+        auto _timer_module = std::dynamic_pointer_cast< timer_module >( framework_manager::get_instance()
+            .get_module_manager().get_module( abstract_module::s_timer_module_name ) );
+        if( _timer_module )
+        {
+            _timer_module->reset_timer( timer_id, autoscale_interval );
+        }
+    }
+}
+
+thread_manager::pool_config thread_manager::get_pool_config()const
+{
+    pool_config config;
+    config.m_min_worker_num = m_min_worker_num.load();
+    config.m_max_worker_num = m_max_worker_num.load();
+    config.m_max_task_wait_time = std::chrono::duration_cast< std::chrono::milliseconds >(
+        std::chrono::nanoseconds( m_max_task_wait_time.load() ) );
+    config.m_idle_retire_time = std::chrono::duration_cast< std::chrono::milliseconds >(
+        std::chrono::nanoseconds( m_idle_retire_time.load() ) );
+    config.m_autoscale_interval = std::chrono::duration_cast< std::chrono::milliseconds >(
+        std::chrono::nanoseconds( m_autoscale_interval.load() ) );
+
+    std::lock_guard<std::recursive_mutex> locker( m_mutex );
+    config.m_worker_cpus = m_worker_cpus;
+    config.m_pin_each_worker = m_pin_each_worker;
+    return config;
+}
+
+std::vector<thread_manager::numa_node_statistics> thread_manager::get_numa_statistics()const
+{
+    std::vector<numa_node_statistics> statistics( m_numa_nodes.size() );
+    for( size_t node = 0; node < m_numa_nodes.size(); ++node )
+    {
+        statistics[node].m_cpus = m_numa_nodes[node]->m_cpus;
+        statistics[node].m_local_claim_count = m_numa_nodes[node]->m_local_claim_count.load();
+        statistics[node].m_remote_claim_count = m_numa_nodes[node]->m_remote_claim_count.load();
+        statistics[node].m_local_steal_count = m_numa_nodes[node]->m_local_steal_count.load();
+        statistics[node].m_remote_steal_count = m_numa_nodes[node]->m_remote_steal_count.load();
+    }
+
+    std::shared_lock<std::shared_mutex> locker( m_stealable_mutex );
+    for( auto& worker : m_stealable_workers )
+    {
+        size_t node = static_cast< size_t >( worker->m_numa_node.load( std::memory_order_relaxed ) );
+        if( node < statistics.size() )
+        {
+            ++statistics[node].m_worker_num;
+        }
+    }
+    return statistics;
 }
 
-void thread_manager::set_current_thread_module_owner( std::string a_module_name )
+thread_manager::pool_statistics thread_manager::get_pool_statistics()const
 {
-    s_thread_module_owner = std::move( a_module_name );
+    pool_statistics statistics;
+    statistics.m_worker_num = m_worker_count.load();
+    statistics.m_idle_worker_num = m_idle_worker_count.load();
+    statistics.m_backlog_length = m_sampled_backlog_length.load();
+    statistics.m_oldest_wait_time = std::chrono::duration_cast< std::chrono::microseconds >(
+        std::chrono::nanoseconds( m_sampled_oldest_wait.load() ) );
+    statistics.m_utilization = m_sampled_utilization.load() / 1000.0;
+    statistics.m_sample_count = m_sample_count.load();
+    statistics.m_latency_miss_count = m_latency_miss_count.load();
+    statistics.m_grow_count = m_grow_count.load();
+    statistics.m_grow_blocked_count = m_grow_blocked_count.load();
+    statistics.m_retire_count = m_retire_count.load();
+    statistics.m_expired_task_count = m_expired_task_count.load();
+    statistics.m_blocked_worker_num = m_blocked_worker_count.load();
+    statistics.m_compensation_count = m_compensation_count.load();
+    return statistics;
 }
 
 void thread_manager::run( bool a_occupy_current_thread )
 {
+    m_stopping.store( false );
     std::shared_ptr<abstract_worker> current_thread_worker;
     if( a_occupy_current_thread )
     {
@@ -54,42 +238,31 @@ void thread_manager::run( bool a_occupy_current_thread )
 
     std::unique_lock<std::recursive_mutex> locker( m_mutex );
     /**
-     * If there is no worker to do work, then recruit some one.
+     * Recruit the minimum workers. Tasks posted while the modules initialized may
+     * have recruited some already.
      */
-    if( m_idle_worker.empty() )
+    uint32_t min_worker_num = m_min_worker_num.load();
+    for( uint32_t i = m_worker_count.load(); i < min_worker_num; ++i )
     {
-        m_idle_worker.emplace_back( make_worker() );
-        m_idle_worker.emplace_back( make_worker() );
-        for( auto& ele : m_idle_worker )
-        {
-            ele->run( ele, false );
-        }
+        add_worker();
     }
 
     if( current_thread_worker )
     {
-        m_idle_worker.push_back( current_thread_worker );
+        apply_worker_affinity( current_thread_worker.get() );
+        m_caller_worker.store( current_thread_worker.get() );
+        link_idle_worker( current_thread_worker.get() );
     }
+    m_retire_period_start = steady_now();
 
-    if( 0 != m_schedule_timer_id )
+    if( 0 == m_schedule_timer_id )
     {
-        std::shared_ptr<abstract_task> task;
         auto fun = [this]()->bool
         {
-            auto _module = framework_manager::get_instance()
-                .get_module_manager().get_module( abstract_module::s_timer_module_name );
-            auto _timer_module = std::dynamic_pointer_cast< timer_module >( _module );
-            auto timer_cb = [this]( uint32_t, std::string )->bool
-            {
-                schedule_workers();
-                return false;
-            };
-            m_schedule_timer_id = _timer_module->register_timer( timer_cb,
-                std::chrono::milliseconds( 2310 ) );
-            LogUtilInfo() << "schedule timer registered.";
+            register_autoscale_timer();
             return false;
         };
-        m_work_need_assign.push_back( std::make_shared<executable_task>( fun ) );
+        push_backlog_task( make_task<executable_task>( fun ) );
     }
 
     locker.unlock();
@@ -101,16 +274,6 @@ void thread_manager::run( bool a_occupy_current_thread )
 
 }
 
-void thread_manager::post_task( std::function<void()> a_tsk )
-{
-    if( a_tsk )
-    {
-        auto tsk =  std::make_shared<executable_task>();
-        tsk->set_fun( a_tsk, abstract_module::s_task_runner_module_name );
-        post_task( tsk );
-    }
-}
-
 void thread_manager::post_delay_task
     (
     std::chrono::milliseconds a_delay_time,
@@ -133,19 +296,33 @@ void thread_manager::post_delay_task
 
 void thread_manager::post_task( std::shared_ptr<abstract_task> a_task )
 {
-    std::unique_lock<std::recursive_mutex> locker( m_mutex );
+    // Pairs with stop: either we see m_stopping, or stop waits until this task is queued and clears it.
+    m_posting_count.fetch_add( 1 );
+    auto_guard posting_guard( [this]() { m_posting_count.fetch_sub( 1 ); } );
+    if( m_stopping.load() )
+    {
+        m_cancelled_task_count.fetch_add( 1 );
+        return;
+    }
 
-    std::string const& _module = a_task->get_target_module();
-    if( _module.empty() )
+    module_id _module = a_task->get_target_module_id();
+    if( s_no_module_id == _module )
     {
         if( a_task->get_task_type() == task_type::framework_event )
         {
+            // Each module gets an envelope of the same event, posted as one batch.
+            auto event_ = std::static_pointer_cast<framework_event>( std::move( a_task ) );
             std::vector<std::shared_ptr<abstract_task>> tasks;
-            for( auto& ele : m_modules_shcedule )
             {
-                std::shared_ptr<abstract_task> cloned_task = a_task->clone();
-                cloned_task->set_target_module( ele.first );
-                tasks.emplace_back( std::move( cloned_task ) );
+                std::shared_lock<std::shared_mutex> locker( m_modules_mutex );
+                tasks.reserve( m_modules_shcedule.size() );
+                for( auto& ele : m_modules_shcedule )
+                {
+                    if( s_no_module_id != ele.second->m_module_id )
+                    {
+                        tasks.emplace_back( make_task<event_envelope>( event_, ele.second->m_module_id ) );
+                    }
+                }
             }
             post_task( std::move( tasks ) );
             return;
@@ -156,19 +333,13 @@ void thread_manager::post_task( std::shared_ptr<abstract_task> a_task )
         }
     }
 
-    if( !_module.empty() && !m_modules_shcedule.contains( _module ) )
-    {
-        LogUtilError() << "Such module has not registered: " << _module;
-    }
-
-    module_task_cb& cb = m_modules_shcedule[_module];
-    switch( cb.module_type_value )
+    module_task_cb& cb = get_module_cb( _module );
+    switch( cb.module_type_value.load( std::memory_order_relaxed ) )
     {
     case abstract_module::module_type::sequence_executing:
         schedule_sequence_task( cb, std::move( a_task ) );
         return;
     case abstract_module::module_type::execute_task_when_post:
-        locker.unlock();
         schedule_immediately_task( std::move( a_task ), _module );
         return;
     case abstract_module::module_type::concurrently_executing:
@@ -177,6 +348,9 @@ void thread_manager::post_task( std::shared_ptr<abstract_task> a_task )
     case abstract_module::module_type::handler_shchedule:
         schedule_handler_task( std::move( a_task ) );
         return;
+    case abstract_module::module_type::dedicated_thread:
+        schedule_dedicated_task( cb, std::move( a_task ) );
+        return;
     default:
         LogUtilError() << "unknown module task type.";
         break;
@@ -185,299 +359,1353 @@ void thread_manager::post_task( std::shared_ptr<abstract_task> a_task )
 
 void thread_manager::post_task( std::vector<std::shared_ptr<abstract_task>> a_tasks )
 {
-    for( auto& ele : a_tasks )
+    m_posting_count.fetch_add( 1 );
+    auto_guard posting_guard( [this]() { m_posting_count.fetch_sub( 1 ); } );
+    if( m_stopping.load() )
     {
-        post_task( ele );
+        m_cancelled_task_count.fetch_add( a_tasks.size() );
+        return;
     }
-}
 
-void thread_manager::push_idle_worker( std::shared_ptr<abstract_worker> a_worker )
-{
-    std::lock_guard<std::recursive_mutex> locker( m_mutex );
-    bool task_assigned = false;
-    for( auto it = m_modules_shcedule.begin(); it != m_modules_shcedule.end(); ++it )
+    /**
+     * Group the tasks by target module, then each module control block is locked
+     * once and each worker is woken once. Tasks of one module keep their order.
+     * A task scheduled one by one flushes the groups first, so the batch is
+     * scheduled in its order.
+     */
+    std::vector<std::pair<module_task_cb*, std::vector<std::shared_ptr<abstract_task>>>> sequence_groups;
+    std::unordered_map<module_task_cb*, size_t> group_index;
+    std::vector<std::shared_ptr<abstract_task>> concurrently_tasks;
+    auto flush_groups = [&]()
     {
-        if( it->second.m_executing_worker == a_worker )
+        for( auto& group : sequence_groups )
         {
-            if( it->second.pending_tasks.empty() )
-            {
-                it->second.m_executing_worker.reset();
-            }
-            else
-            {
-                std::vector<std::shared_ptr<abstract_task>> tasks
-                    ( it->second.pending_tasks.begin(), it->second.pending_tasks.end() );
-                a_worker->post_task( tasks );
-                it->second.pending_tasks.clear();
-                task_assigned = true;
-            }
+            schedule_sequence_tasks( *group.first, std::move( group.second ) );
         }
-        else
+        sequence_groups.clear();
+        group_index.clear();
+
+        if( !concurrently_tasks.empty() )
         {
-            // if no worker doing these work currently, we need find a worker to do
-            if( !( it->second.m_executing_worker ) )
-            {
-                if( !( it->second.pending_tasks.empty() ) )
-                {
-                    std::shared_ptr<abstract_worker> worker;
-                    worker = find_idle_worker();
-                    if( worker )
-                    {
-                        assign_work( worker, it->second.pending_tasks );
-                        it->second.pending_tasks.clear();
-                        it->second.m_executing_worker = worker;
-                    }
-                }
-            }
+            schedule_concurrently_tasks( std::move( concurrently_tasks ) );
+            concurrently_tasks.clear();
         }
-    }
+    };
 
-    if( task_assigned )
+    module_task_cb* cb = nullptr;
+    for( auto& ele : a_tasks )
     {
-        return;
-    }
+        module_id _module = ele->get_target_module_id();
+        if( s_no_module_id == _module )
+        {
+            // Broadcast events are expanded there and come back as a batch.
+            flush_groups();
+            post_task( std::move( ele ) );
+            continue;
+        }
 
+        if( !cb || cb->m_module_id != _module )
+        {
+            cb = &get_module_cb( _module );
+        }
 
-    if( !m_work_need_assign.empty() )
-    {
-        // There is a work need to do and assign to a_worker. So do not
-        // push it into idle worker list.
-        a_worker->post_task( m_work_need_assign.front() );
-        m_work_need_assign.erase( m_work_need_assign.begin() );
-        return;
+        switch( cb->module_type_value.load( std::memory_order_relaxed ) )
+        {
+        case abstract_module::module_type::sequence_executing:
+        {
+            auto it = group_index.try_emplace( cb, sequence_groups.size() ).first;
+            if( it->second == sequence_groups.size() )
+            {
+                sequence_groups.emplace_back( cb, std::vector<std::shared_ptr<abstract_task>>{} );
+            }
+            sequence_groups[it->second].second.emplace_back( std::move( ele ) );
+            break;
+        }
+        case abstract_module::module_type::execute_task_when_post:
+            flush_groups();
+            schedule_immediately_task( std::move( ele ), _module );
+            break;
+        case abstract_module::module_type::concurrently_executing:
+            concurrently_tasks.emplace_back( std::move( ele ) );
+            break;
+        case abstract_module::module_type::handler_shchedule:
+            flush_groups();
+            schedule_handler_task( std::move( ele ) );
+            break;
+        case abstract_module::module_type::dedicated_thread:
+            flush_groups();
+            schedule_dedicated_task( *cb, std::move( ele ) );
+            break;
+        default:
+            LogUtilError() << "unknown module task type.";
+            break;
+        }
     }
+    flush_groups();
+}
 
-    if( std::find( m_idle_worker.begin(), m_idle_worker.end(), a_worker ) == m_idle_worker.end() )
+void thread_manager::push_idle_worker( std::shared_ptr<abstract_worker> a_worker )
+{
+    abstract_worker* worker = a_worker.get();
     {
-        m_idle_worker.push_back( a_worker );
+        /**
+         * a_worker may be still in the idle list if it was woken by a task posted to
+         * it directly. Take it back, then no one else will touch its owned modules.
+         */
+        std::lock_guard<std::recursive_mutex> locker( m_mutex );
+        unlink_idle_worker( worker );
     }
 
-    auto it = std::find( m_working_worker.begin(), m_working_worker.end(), a_worker );
-    if( it != m_working_worker.end() )
+    while( true )
     {
-        m_working_worker.erase( it );
-    }
-}
+        if( worker->has_pending_task() )
+        {
+            /**
+             * Some tasks were posted to a_worker after it found nothing to do. Keep
+             * its sequence modules, otherwise a later task of such module may be
+             * executed by another worker before these ones.
+             */
+            return;
+        }
 
-void thread_manager::register_module_type
-    (
-    abstract_module::module_type a_type,
-    std::string a_module_name
-    )
-{
-    module_task_cb cb;
-    cb.module_name = a_module_name;
-    cb.module_type_value = a_type;
+        if( assign_sequence_work( worker ) )
+        {
+            return;
+        }
 
-    std::lock_guard<std::recursive_mutex> locker( m_mutex );
-    if( !m_modules_shcedule.contains( a_module_name ) )
-    {
-        m_modules_shcedule[a_module_name] = cb;
-    }
-    else
-    {
-        LogUtilInfo() << "Already has " << a_module_name << ", change module tye.";
-        m_modules_shcedule[a_module_name].module_type_value = a_type;
-    }
-}
+        /**
+         * The blocker a_worker compensated for has left, while the others are still busy.
+         * Park it instead of taking more work, it retires if no one blocks again soon.
+         */
+        if( is_beyond_worker_limit( 0 ) )
+        {
+            std::lock_guard<std::recursive_mutex> locker( m_mutex );
+            link_idle_worker( worker );
+            dismiss_long_idle_worker();
+            return;
+        }
 
-uint64_t thread_manager::get_scheduled_thread_id( std::string const& a_moudle_name )const
-{
-    std::lock_guard locker( m_mutex );
-    for( auto it = m_modules_shcedule.begin(); it != m_modules_shcedule.end(); ++it )
-    {
-        if( a_moudle_name == it->first )
+        std::shared_ptr<abstract_task> backlog_task = pop_backlog_task();
+        if( !backlog_task )
+        {
+            backlog_task = steal_task( worker );
+        }
+
+        if( backlog_task )
+        {
+            // There is a work need to do and assign to a_worker. So do not
+            // push it into idle worker list.
+            worker->post_task( std::move( backlog_task ) );
+            return;
+        }
+
+        std::lock_guard<std::recursive_mutex> locker( m_mutex );
+        link_idle_worker( worker );
+        dismiss_long_idle_worker();
+
+        /**
+         * Producers push into the backlog or the ready module queue without m_mutex,
+         * then check the idle worker count. Pairs with the fences in
+         * schedule_concurrently_task and schedule_sequence_task: either the producer
+         * sees this idle worker, or we see its task here.
+         */
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        backlog_task = pop_backlog_task();
+        if( !backlog_task )
+        {
+            backlog_task = steal_task( worker );
+        }
+
+        if( backlog_task )
+        {
+            assign_work( worker, std::move( backlog_task ) );
+            return;
+        }
+
+        if( m_ready_module_count.load( std::memory_order_relaxed ) == 0 )
         {
-            auto& worker = it->second.m_executing_worker;
-            if( worker )
-            return worker->work_thread_id();
+            return;
+        }
+
+        // A sequence module is waiting for a worker. Take a_worker back and scan again,
+        // unless someone has already assigned work to it.
+        if( !unlink_idle_worker( worker ) )
+        {
+            return;
         }
     }
-    return 0;
 }
 
-void thread_manager::remove_worker( std::shared_ptr<abstract_worker> a_worker )
+bool thread_manager::assign_sequence_work( abstract_worker* a_worker )
 {
-    std::lock_guard<std::recursive_mutex> locker( m_mutex );
-    for( auto it = m_idle_worker.begin(); it != m_idle_worker.end(); )
+    bool deferred = false;
+    std::vector<module_task_cb*>& owned_modules = a_worker->m_owned_modules;
+    for( auto it = owned_modules.begin(); it != owned_modules.end(); )
     {
-        if( it->get() == a_worker.get() )
+        module_task_cb& cb = **it;
+        std::lock_guard<std::mutex> locker( cb.m_mutex );
+        if( cb.m_executing_worker != a_worker )
         {
-            it = m_idle_worker.erase( it );
+            it = owned_modules.erase( it );
+        }
+        else if( a_worker->has_pending_task() )
+        {
+            // a_worker may hold tasks of its modules now, keep them.
+            return true;
         }
         else
         {
-            ++it;
+            cb.m_executing_worker = nullptr;
+            it = owned_modules.erase( it );
+            if( !cb.pending_tasks.empty() )
+            {
+                // Deferred for using more than its share, it waits for a worker like others.
+                push_ready_module( cb );
+                deferred = true;
+            }
         }
     }
 
-    for( auto it = m_working_worker.begin(); it != m_working_worker.end(); )
+    bool assigned = false;
+    for( module_task_cb* cb = is_beyond_worker_limit( 0 ) ? nullptr : pop_ready_module(); cb;
+        cb = pop_ready_module() )
     {
-        if( it->get() == a_worker.get() )
+        std::lock_guard<std::mutex> locker( cb->m_mutex );
+        cb->m_ready = false;
+        if( cb->m_executing_worker || cb->pending_tasks.empty() )
         {
-            it = m_working_worker.erase( it );
+            continue;
         }
-        else
+
+        // A module placed on a remote node goes to an idle worker of that node if any.
+        int32_t node = cb->m_numa_node.load( std::memory_order_relaxed );
+        if( node >= 0 && node != a_worker->m_numa_node.load( std::memory_order_relaxed ) &&
+            m_numa_nodes.size() > 1 && claim_worker_for_module( *cb ) )
         {
-            ++it;
+            check_task_wait_time( cb->m_ready_time );
+            continue;
         }
+
+        record_numa_claim( a_worker, *cb );
+        bind_worker_to_module( a_worker, *cb );
+        a_worker->post_task( take_pending_batch( *cb ) );
+        cb->m_executing_worker = a_worker;
+        owned_modules.push_back( cb );
+        check_task_wait_time( cb->m_ready_time );
+        assigned = true;
+        break;
     }
 
-    for( auto it = m_modules_shcedule.begin(); it != m_modules_shcedule.end(); ++it )
+    if( deferred )
     {
-        if( it->second.m_executing_worker.get() == a_worker.get() )
-        {
-            it->second.m_executing_worker.reset();
-        }
+        dispatch_ready_modules();
     }
+    return assigned;
 }
 
-void thread_manager::schedule_workers()
+void thread_manager::push_ready_module( module_task_cb& a_task_cb )
 {
-    std::lock_guard<std::recursive_mutex> locker( m_mutex );
-    if( !m_idle_worker.empty() )
+    if( a_task_cb.m_ready )
     {
         return;
     }
+    a_task_cb.m_ready = true;
 
-    if( m_working_worker.size() < s_max_worker_num )
+    // A module slept for long should not take the workers until it catches up with others.
+    int64_t floor = m_min_vruntime.load( std::memory_order_relaxed ) -
+        std::chrono::nanoseconds( s_fair_share_granularity ).count();
+    int64_t vruntime = a_task_cb.m_vruntime.load( std::memory_order_relaxed );
+    if( vruntime < floor )
     {
-        std::shared_ptr<abstract_worker> worker = make_worker();
-        worker->run( worker, false );
-        m_idle_worker.push_back( worker );
+        vruntime = floor;
+        a_task_cb.m_vruntime.store( vruntime, std::memory_order_relaxed );
     }
+
+    std::lock_guard<std::mutex> locker( m_ready_mutex );
+    m_ready_heap.emplace_back( vruntime, &a_task_cb );
+    std::push_heap( m_ready_heap.begin(), m_ready_heap.end(), std::greater<>() );
+    m_ready_min_vruntime.store( m_ready_heap.front().first, std::memory_order_relaxed );
+    m_ready_module_count.fetch_add( 1 );
 }
 
-std::shared_ptr<abstract_worker> thread_manager::find_idle_worker()
+thread_manager::module_task_cb* thread_manager::pop_ready_module()
 {
-    std::shared_ptr<abstract_worker> worker;
-    if( !m_idle_worker.empty() )
+    if( m_ready_module_count.load( std::memory_order_relaxed ) == 0 )
     {
-        worker = m_idle_worker.front();
-        m_idle_worker.erase( m_idle_worker.begin() );
+        return nullptr;
     }
-    else
+
+    std::lock_guard<std::mutex> locker( m_ready_mutex );
+    if( m_ready_heap.empty() )
     {
-        schedule_workers();
-        if( m_idle_worker.empty() )
-        {
-            return worker;
-        }
-        else
-        {
-            worker = m_idle_worker.front();
-            m_idle_worker.erase( m_idle_worker.begin() );
-        }
+        return nullptr;
     }
 
-    dismiss_long_idle_worker();
-    return worker;
-}
-
-void thread_manager::assign_work
-    (
-    std::shared_ptr<abstract_worker>& a_worker,
-    std::shared_ptr<abstract_task>& a_task
-    )
-{
-    a_worker->post_task( a_task );
-    auto it = std::find( m_idle_worker.begin(), m_idle_worker.end(), a_worker );
-    if( it != m_idle_worker.end() )
+    std::pop_heap( m_ready_heap.begin(), m_ready_heap.end(), std::greater<>() );
+    auto [vruntime, cb] = m_ready_heap.back();
+    m_ready_heap.pop_back();
+    m_ready_module_count.fetch_sub( 1 );
+    if( !m_ready_heap.empty() )
     {
-        m_idle_worker.erase( it );
+        m_ready_min_vruntime.store( m_ready_heap.front().first, std::memory_order_relaxed );
     }
 
-    auto it_ = std::find( m_working_worker.begin(), m_working_worker.end(), a_worker );
-    if( it_ == m_working_worker.end() )
+    if( vruntime > m_min_vruntime.load( std::memory_order_relaxed ) )
     {
-        m_working_worker.push_back( a_worker );
+        m_min_vruntime.store( vruntime, std::memory_order_relaxed );
     }
+    return cb;
 }
 
-void thread_manager::assign_work
-    (
-    std::shared_ptr<abstract_worker>& a_worker,
-    std::list<std::shared_ptr<abstract_task>>& a_task
-    )
+std::vector<std::shared_ptr<abstract_task>> thread_manager::take_pending_batch( module_task_cb& a_task_cb )
 {
-    std::vector<std::shared_ptr<abstract_task>> tasks( a_task.begin(), a_task.end() );
-    a_worker->post_task( tasks );
-
-    auto it = std::find( m_idle_worker.begin(), m_idle_worker.end(), a_worker );
-    if( it != m_idle_worker.end() )
-    {
-        m_idle_worker.erase( it );
-    }
-
-    auto it_ = std::find( m_working_worker.begin(), m_working_worker.end(), a_worker );
-    if( it_ == m_working_worker.end() )
+    auto batch_end = a_task_cb.pending_tasks.begin();
+    std::advance( batch_end, std::min<size_t>( a_task_cb.pending_tasks.size(), s_max_sequence_batch ) );
+    std::vector<std::shared_ptr<abstract_task>> tasks
+        ( std::make_move_iterator( a_task_cb.pending_tasks.begin() ), std::make_move_iterator( batch_end ) );
+    a_task_cb.pending_tasks.erase( a_task_cb.pending_tasks.begin(), batch_end );
+    if( !a_task_cb.pending_tasks.empty() )
     {
-        m_working_worker.push_back( a_worker );
+        a_task_cb.m_ready_time = steady_now();
     }
+    return tasks;
 }
 
-void thread_manager::dismiss_long_idle_worker()
+bool thread_manager::is_over_share( module_task_cb const& a_task_cb )const
 {
-    if( m_idle_worker.size() > 2 )
-    {
-        for( auto& ele : m_idle_worker )
-        {
-            if( ele->is_idle_for_long_time() )
-            {
-                ele->exit_later();
-                return;
-            }
-        }
-    }
+    return m_ready_module_count.load( std::memory_order_relaxed ) > 0 &&
+        a_task_cb.m_vruntime.load( std::memory_order_relaxed ) - m_ready_min_vruntime.load( std::memory_order_relaxed ) >
+        std::chrono::nanoseconds( s_fair_share_granularity ).count();
 }
 
-void thread_manager::schedule_sequence_task
-    (
-    module_task_cb& a_task_cb,
-    std::shared_ptr<abstract_task> a_task
-    )
+void thread_manager::dispatch_ready_modules()
 {
-    if( a_task_cb.m_executing_worker )
-    {
-        a_task_cb.m_executing_worker->post_task( a_task );
-        return;
-    }
-    else
+    while( m_idle_worker_count.load( std::memory_order_relaxed ) > 0 )
     {
-        std::shared_ptr<abstract_worker> worker;
-        worker = find_idle_worker();
-        if( worker )
+        module_task_cb* cb = pop_ready_module();
+        if( !cb )
         {
-            assign_work( worker, a_task );
-            a_task_cb.m_executing_worker = worker;
             return;
         }
-        else
+
+        std::lock_guard<std::mutex> locker( cb->m_mutex );
+        cb->m_ready = false;
+        if( cb->m_executing_worker || cb->pending_tasks.empty() )
+        {
+            continue;
+        }
+
+        int64_t ready_time = cb->m_ready_time;
+        if( !claim_worker_for_module( *cb ) )
         {
-            // There are maybe no more workers. So we cache this task.
-            a_task_cb.pending_tasks.push_back( a_task );
+            push_ready_module( *cb );
             return;
         }
+        check_task_wait_time( ready_time );
     }
 }
 
-void thread_manager::schedule_immediately_task
+void thread_manager::register_module_type
     (
-    std::shared_ptr<abstract_task> a_task,
-    std::string const& a_module
+    abstract_module::module_type a_type,
+    std::string a_module_name
     )
 {
-    s_thread_module_owner = a_module;
-    auto_guard guard( [this]() { s_thread_module_owner.clear(); } );
-    auto detail_module = framework_manager::get_instance().get_module_manager().get_module( a_module );
-    if( detail_module )
+    std::lock_guard<std::shared_mutex> locker( m_modules_mutex );
+    if( m_modules_shcedule.find( a_module_name ) != m_modules_shcedule.end() )
     {
-        detail_module->handle_task( a_task );
+        LogUtilInfo() << "Already has " << a_module_name << ", change module tye.";
     }
-    else
+    module_task_cb& cb = create_module_cb( a_module_name );
+    cb.module_type_value = a_type;
+
+    std::lock_guard<std::mutex> cb_locker( cb.m_mutex );
+    if( a_type == abstract_module::module_type::dedicated_thread )
     {
-        LogUtilError() << "No such module: " << a_module;
-    }
+        if( !cb.m_dedicated_worker )
+        {
+            start_dedicated_worker( cb );
+        }
+    }
+    else if( cb.m_dedicated_worker )
+    {
+        stop_dedicated_worker( cb );
+    }
+}
+
+uint64_t thread_manager::get_scheduled_thread_id( std::string const& a_moudle_name )const
+{
+    std::shared_lock<std::shared_mutex> modules_locker( m_modules_mutex );
+    auto it = m_modules_shcedule.find( a_moudle_name );
+    if( it != m_modules_shcedule.end() )
+    {
+        std::lock_guard<std::mutex> locker( it->second->m_mutex );
+        if( it->second->m_dedicated_worker )
+        {
+            return it->second->m_dedicated_worker->work_thread_id();
+        }
+        auto& worker = it->second->m_executing_worker;
+        if( worker )
+        return worker->work_thread_id();
+    }
+    return 0;
+}
+
+bool thread_manager::drop_expired_task( std::shared_ptr<abstract_task> const& a_task )
+{
+    if( !a_task->is_expired( std::chrono::steady_clock::now() ) )
+    {
+        return false;
+    }
+
+    module_id target = a_task->get_target_module_id();
+    module_task_cb& cb = get_module_cb( s_no_module_id == target ? abstract_module::get_task_runner_module_id() : target );
+    cb.m_expired_task_count.fetch_add( 1, std::memory_order_relaxed );
+    m_expired_task_count.fetch_add( 1, std::memory_order_relaxed );
+    LogUtilDebug() << "drop expired task to " << cb.module_name << ", from " << a_task->get_source_module()
+        << ", position: " << a_task->get_position().to_string();
+    return true;
+}
+
+uint64_t thread_manager::get_expired_task_count( std::string const& a_module )const
+{
+    std::shared_lock<std::shared_mutex> modules_locker( m_modules_mutex );
+    auto it = m_modules_shcedule.find( a_module );
+    if( it != m_modules_shcedule.end() )
+    {
+        return it->second->m_expired_task_count.load();
+    }
+    return 0;
+}
+
+void thread_manager::remove_worker
+    (
+    std::shared_ptr<abstract_worker> a_worker,
+    std::vector<std::shared_ptr<abstract_task>> a_unhandled_tasks
+    )
+{
+    module_task_cb* dedicated_cb = a_worker->m_dedicated_module;
+    if( dedicated_cb )
+    {
+        // Not in the pool. The later tasks of its module go to a new thread, if still dedicated.
+        {
+            std::lock_guard<std::mutex> cb_locker( dedicated_cb->m_mutex );
+            a_worker->take_posted_tasks( a_unhandled_tasks );
+            if( dedicated_cb->m_dedicated_worker == a_worker )
+            {
+                dedicated_cb->m_dedicated_worker.reset();
+            }
+        }
+
+        if( !a_unhandled_tasks.empty() )
+        {
+            post_task( std::move( a_unhandled_tasks ) );
+        }
+        return;
+    }
+
+    std::unique_lock<std::recursive_mutex> locker( m_mutex );
+    unlink_idle_worker( a_worker.get() );
+    abstract_worker* caller_worker = a_worker.get();
+    m_caller_worker.compare_exchange_strong( caller_worker, nullptr );
+    if( a_worker->m_pool_state == abstract_worker::pool_state::working )
+    {
+        --m_working_worker_count;
+        m_worker_count.fetch_sub( 1 );
+    }
+    a_worker->m_pool_state = abstract_worker::pool_state::detached;
+    locker.unlock();
+
+    /**
+     * No one can take a_worker from the idle list now, so its modules are stable.
+     * Tasks are posted to a module's worker with the module locked, so after taking
+     * the posted tasks under the lock, no more task of that module will come. These
+     * tasks are older than the deferred ones in pending_tasks, put them in front.
+     */
+    bool made_ready = false;
+    for( module_task_cb* cb : a_worker->m_owned_modules )
+    {
+        std::lock_guard<std::mutex> cb_locker( cb->m_mutex );
+        if( cb->m_executing_worker != a_worker.get() )
+        {
+            continue;
+        }
+
+        cb->m_executing_worker = nullptr;
+        a_worker->take_posted_tasks( a_unhandled_tasks );
+        auto module_tasks_end = std::stable_partition( a_unhandled_tasks.begin(), a_unhandled_tasks.end(),
+            [cb]( std::shared_ptr<abstract_task> const& a_task )
+            {
+                return a_task->get_target_module_id() != cb->m_module_id;
+            } );
+        if( module_tasks_end == a_unhandled_tasks.end() && cb->pending_tasks.empty() )
+        {
+            continue;
+        }
+
+        if( cb->pending_tasks.empty() )
+        {
+            cb->m_ready_time = steady_now();
+        }
+        cb->pending_tasks.insert( cb->pending_tasks.begin(),
+            std::make_move_iterator( module_tasks_end ), std::make_move_iterator( a_unhandled_tasks.end() ) );
+        a_unhandled_tasks.erase( module_tasks_end, a_unhandled_tasks.end() );
+        cb->pending_tasks.sort( []( std::shared_ptr<abstract_task> const& a_left, std::shared_ptr<abstract_task> const& a_right )
+            {
+                return a_left->get_priority() < a_right->get_priority();
+            } );
+        push_ready_module( *cb );
+        made_ready = true;
+    }
+    a_worker->m_owned_modules.clear();
+    a_worker->take_posted_tasks( a_unhandled_tasks );
+
+    std::unique_lock<std::shared_mutex> stealable_locker( m_stealable_mutex );
+    for( auto it = m_stealable_workers.begin(); it != m_stealable_workers.end(); ++it )
+    {
+        if( it->get() == a_worker.get() )
+        {
+            m_stealable_workers.erase( it );
+            break;
+        }
+    }
+    stealable_locker.unlock();
+
+    if( !a_unhandled_tasks.empty() )
+    {
+        post_task( std::move( a_unhandled_tasks ) );
+    }
+
+    if( made_ready )
+    {
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if( m_idle_worker_count.load() > 0 )
+        {
+            dispatch_ready_modules();
+        }
+    }
+}
+
+void thread_manager::schedule_workers()
+{
+    std::lock_guard<std::recursive_mutex> locker( m_mutex );
+    if( m_idle_head )
+    {
+        return;
+    }
+
+    if( m_worker_count.load() < m_min_worker_num.load( std::memory_order_relaxed ) )
+    {
+        add_worker();
+    }
+}
+
+void thread_manager::add_worker()
+{
+    if( m_stopping.load() )
+    {
+        return;
+    }
+
+    std::shared_ptr<abstract_worker> worker = make_worker();
+    apply_worker_affinity( worker.get() );
+    worker->run( worker, false );
+    link_idle_worker( worker.get() );
+    m_grow_count.fetch_add( 1, std::memory_order_relaxed );
+}
+
+void thread_manager::apply_worker_affinity( abstract_worker* a_worker )
+{
+    if( m_worker_cpus.empty() )
+    {
+        if( m_numa_nodes.size() < 2 )
+        {
+            return;
+        }
+
+        // Spread the workers across the nodes, each one floats inside its own node.
+        size_t node = m_next_numa_node++ % m_numa_nodes.size();
+        for( size_t i = 0; i < m_numa_nodes.size() && m_numa_nodes[node]->m_cpus.empty(); ++i )
+        {
+            node = m_next_numa_node++ % m_numa_nodes.size();
+        }
+        a_worker->m_numa_node.store( static_cast< int32_t >( node ) );
+        a_worker->set_affinity( m_numa_nodes[node]->m_cpus );
+        return;
+    }
+
+    if( m_pin_each_worker )
+    {
+        uint32_t cpu = m_worker_cpus[m_next_pinned_cpu++ % m_worker_cpus.size()];
+        a_worker->m_pinned_cpu = static_cast< int32_t >( cpu );
+        a_worker->m_numa_node.store( get_cpu_numa_node( cpu ) );
+        a_worker->set_affinity( { cpu } );
+        return;
+    }
+
+    a_worker->m_pinned_cpu = m_worker_cpus.size() == 1 ? static_cast< int32_t >( m_worker_cpus.front() ) : -1;
+    a_worker->m_numa_node.store( get_cpu_numa_node( m_worker_cpus.front() ) );
+    a_worker->set_affinity( m_worker_cpus );
+}
+
+int32_t thread_manager::get_cpu_numa_node( uint32_t a_cpu )const
+{
+    return a_cpu < m_cpu_numa_node.size() ? m_cpu_numa_node[a_cpu] : 0;
+}
+
+void thread_manager::record_numa_claim
+    (
+    abstract_worker const* a_worker,
+    module_task_cb const& a_task_cb
+    )
+{
+    size_t node = static_cast< size_t >( a_task_cb.m_numa_node.load( std::memory_order_relaxed ) );
+    if( node >= m_numa_nodes.size() )
+    {
+        return;
+    }
+
+    if( a_worker->m_numa_node.load( std::memory_order_relaxed ) == static_cast< int32_t >( node ) )
+    {
+        m_numa_nodes[node]->m_local_claim_count.fetch_add( 1, std::memory_order_relaxed );
+    }
+    else
+    {
+        m_numa_nodes[node]->m_remote_claim_count.fetch_add( 1, std::memory_order_relaxed );
+    }
+}
+
+void thread_manager::bind_worker_to_module
+    (
+    abstract_worker* a_worker,
+    module_task_cb const& a_task_cb
+    )
+{
+    int32_t cpu = a_task_cb.m_pinned_cpu.load( std::memory_order_relaxed );
+    if( cpu >= 0 && a_worker->m_pinned_cpu != cpu )
+    {
+        a_worker->m_pinned_cpu = cpu;
+        a_worker->m_numa_node.store( get_cpu_numa_node( static_cast< uint32_t >( cpu ) ) );
+        a_worker->set_affinity( { static_cast< uint32_t >( cpu ) } );
+    }
+}
+
+void thread_manager::set_module_cpu( std::string const& a_module, int32_t a_cpu )
+{
+    module_task_cb& cb = get_module_cb( a_module );
+    abstract_module::module_type type = cb.module_type_value.load();
+    if( type != abstract_module::module_type::sequence_executing &&
+        type != abstract_module::module_type::dedicated_thread )
+    {
+        LogUtilWarning() << "only sequence executing or dedicated thread module can be pinned to a cpu: " << a_module;
+        return;
+    }
+
+    std::lock_guard<std::mutex> locker( cb.m_mutex );
+    cb.m_pinned_cpu.store( a_cpu < 0 ? -1 : a_cpu );
+    if( cb.m_dedicated_worker )
+    {
+        cb.m_dedicated_worker->m_pinned_cpu = cb.m_pinned_cpu.load();
+        cb.m_dedicated_worker->set_affinity( a_cpu < 0 ? std::vector<uint32_t>{} : std::vector<uint32_t>{ static_cast< uint32_t >( a_cpu ) } );
+    }
+}
+
+void thread_manager::set_module_numa_node( std::string const& a_module, int32_t a_node )
+{
+    if( a_node >= static_cast< int32_t >( m_numa_nodes.size() ) )
+    {
+        LogUtilWarning() << "no such numa node: " << a_node << ", module: " << a_module;
+        return;
+    }
+
+    module_task_cb& cb = get_module_cb( a_module );
+    if( cb.module_type_value.load() != abstract_module::module_type::sequence_executing )
+    {
+        LogUtilWarning() << "only sequence executing module can be placed on a numa node: " << a_module;
+        return;
+    }
+    cb.m_numa_node.store( a_node < 0 ? -1 : a_node );
+}
+
+void thread_manager::set_module_busy_poll( std::string const& a_module, bool a_busy_poll )
+{
+    module_task_cb& cb = get_module_cb( a_module );
+    if( cb.module_type_value.load() != abstract_module::module_type::dedicated_thread )
+    {
+        LogUtilWarning() << "only dedicated thread module can busy poll: " << a_module;
+        return;
+    }
+
+    std::lock_guard<std::mutex> locker( cb.m_mutex );
+    cb.m_busy_poll.store( a_busy_poll );
+    if( cb.m_dedicated_worker )
+    {
+        cb.m_dedicated_worker->set_dedicated( a_busy_poll );
+    }
+}
+
+void thread_manager::set_module_weight( std::string const& a_module, uint32_t a_weight )
+{
+    module_task_cb& cb = get_module_cb( a_module );
+    cb.m_weight.store( a_weight == 0 ? s_default_module_weight : a_weight );
+}
+
+std::chrono::nanoseconds thread_manager::get_module_cpu_time( std::string const& a_module )const
+{
+    std::shared_lock<std::shared_mutex> modules_locker( m_modules_mutex );
+    auto it = m_modules_shcedule.find( a_module );
+    if( it != m_modules_shcedule.end() )
+    {
+        return std::chrono::nanoseconds( it->second->m_cpu_time.load() );
+    }
+    return std::chrono::nanoseconds( 0 );
+}
+
+void thread_manager::account_task_time( module_id a_module, std::chrono::nanoseconds a_time )
+{
+    module_task_cb& cb = get_module_cb( s_no_module_id == a_module ? abstract_module::get_task_runner_module_id() : a_module );
+
+    int64_t time = a_time.count();
+    cb.m_cpu_time.fetch_add( time, std::memory_order_relaxed );
+    cb.m_vruntime.fetch_add( time * s_default_module_weight / cb.m_weight.load( std::memory_order_relaxed ),
+        std::memory_order_relaxed );
+}
+
+void thread_manager::autoscale()
+{
+    int64_t now = steady_now();
+    size_t backlog_length = backlog_size_approx() + m_ready_module_count.load();
+    int64_t oldest_wait = m_max_observed_wait.exchange( 0 );
+
+    std::unique_lock<std::recursive_mutex> locker( m_mutex );
+    if( 0 == backlog_length || oldest_wait > 0 )
+    {
+        // Nothing is waiting, or workers are taking them.
+        m_backlog_seen_time = backlog_length > 0 ? now : 0;
+    }
+    else if( 0 == m_backlog_seen_time )
+    {
+        m_backlog_seen_time = now;
+    }
+    else
+    {
+        // Nobody took any of them since then.
+        oldest_wait = now - m_backlog_seen_time;
+    }
+
+    uint32_t worker_count = m_worker_count.load();
+    uint32_t idle_count = m_idle_worker_count.load();
+    m_sampled_backlog_length.store( backlog_length, std::memory_order_relaxed );
+    m_sampled_oldest_wait.store( oldest_wait, std::memory_order_relaxed );
+    m_sampled_utilization.store( worker_count > 0 ? ( worker_count - idle_count ) * 1000 / worker_count : 0,
+        std::memory_order_relaxed );
+    m_sample_count.fetch_add( 1, std::memory_order_relaxed );
+
+    if( oldest_wait > m_max_task_wait_time.load( std::memory_order_relaxed ) )
+    {
+        m_latency_miss_count.fetch_add( 1, std::memory_order_relaxed );
+        if( 0 == idle_count )
+        {
+            if( worker_count < get_worker_limit() )
+            {
+                LogUtilDebug() << "Tasks waited " << oldest_wait / 1000000 << "ms for a worker, add one.";
+                add_worker();
+                m_last_grow_time.store( now, std::memory_order_relaxed );
+            }
+            else
+            {
+                m_grow_blocked_count.fetch_add( 1, std::memory_order_relaxed );
+            }
+        }
+    }
+    else if( 0 == backlog_length )
+    {
+        dismiss_long_idle_worker();
+    }
+    locker.unlock();
+
+    // Hand the waiting ones to idle workers, modules need to be locked without m_mutex.
+    if( backlog_length > 0 && m_idle_worker_count.load() > 0 )
+    {
+        dispatch_backlog();
+        dispatch_ready_modules();
+    }
+}
+
+size_t thread_manager::stop( std::chrono::steady_clock::time_point a_deadline )
+{
+    if( s_current_worker )
+    {
+        LogUtilError() << "Can not stop thread manager in its worker.";
+        return 0;
+    }
+
+    m_cancelled_task_count.store( 0 );
+    while( !is_quiescent() && std::chrono::steady_clock::now() < a_deadline )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+
+    // No more workers or tasks from now on, the unhandled ones of quitting workers are cancelled too.
+    m_stopping.store( true );
+    std::vector<std::shared_ptr<abstract_worker>> workers;
+    {
+        std::shared_lock<std::shared_mutex> locker( m_stealable_mutex );
+        workers = m_stealable_workers;
+    }
+    {
+        std::shared_lock<std::shared_mutex> modules_locker( m_modules_mutex );
+        for( auto& ele : m_modules_shcedule )
+        {
+            std::lock_guard<std::mutex> cb_locker( ele.second->m_mutex );
+            if( ele.second->m_dedicated_worker )
+            {
+                workers.push_back( ele.second->m_dedicated_worker );
+            }
+        }
+    }
+
+    for( auto& worker : workers )
+    {
+        worker->exit_later();
+    }
+
+    for( auto& worker : workers )
+    {
+        worker->join();
+    }
+
+    // A worker occupying the thread which called run is not joinable, wait until it leaves.
+    while( m_worker_count.load() > 0 )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+
+    // A producer may have passed the m_stopping check before it was set, wait for its task.
+    while( m_posting_count.load() > 0 )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+
+    size_t cancelled_count = clear_queued_tasks() + m_cancelled_task_count.load();
+    std::lock_guard<std::recursive_mutex> locker( m_mutex );
+    m_schedule_timer_id.store( 0 );
+    LogUtilInfo() << "thread manager stopped, " << workers.size() << " workers joined, "
+        << cancelled_count << " tasks cancelled.";
+    return cancelled_count;
+}
+
+bool thread_manager::is_quiescent()const
+{
+    if( backlog_size_approx() > 0 || m_ready_module_count.load() > 0 )
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::recursive_mutex> locker( m_mutex );
+        if( m_working_worker_count > 0 )
+        {
+            return false;
+        }
+    }
+
+    // An idle worker may have been posted tasks directly.
+    std::shared_lock<std::shared_mutex> locker( m_stealable_mutex );
+    for( auto& worker : m_stealable_workers )
+    {
+        if( worker->has_pending_task() )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t thread_manager::clear_queued_tasks()
+{
+    size_t cleared_count = 0;
+    for( std::shared_ptr<abstract_task> task = pop_backlog_task(); task; task = pop_backlog_task() )
+    {
+        ++cleared_count;
+    }
+
+    {
+        std::lock_guard<std::mutex> locker( m_ready_mutex );
+        m_ready_heap.clear();
+        m_ready_module_count.store( 0 );
+    }
+
+    std::shared_lock<std::shared_mutex> modules_locker( m_modules_mutex );
+    for( auto& ele : m_modules_shcedule )
+    {
+        module_task_cb& cb = *ele.second;
+        std::lock_guard<std::mutex> cb_locker( cb.m_mutex );
+        cleared_count += cb.pending_tasks.size();
+        cb.pending_tasks.clear();
+        cb.m_executing_worker = nullptr;
+        cb.m_ready = false;
+        cb.m_dedicated_worker.reset();
+    }
+    return cleared_count;
+}
+
+uint32_t thread_manager::get_worker_limit()const
+{
+    uint32_t caller_worker_num = m_caller_worker.load( std::memory_order_relaxed ) ? 1 : 0;
+    return m_max_worker_num.load( std::memory_order_relaxed ) + m_blocked_worker_count.load( std::memory_order_relaxed ) +
+        caller_worker_num;
+}
+
+bool thread_manager::is_beyond_worker_limit( uint32_t a_waking )const
+{
+    int64_t running_count = static_cast< int64_t >( m_worker_count.load() ) - m_idle_worker_count.load();
+    return running_count + a_waking > static_cast< int64_t >( get_worker_limit() );
+}
+
+bool thread_manager::enter_blocking_region()
+{
+    if( !s_current_worker )
+    {
+        return false;
+    }
+
+    if( s_blocking_depth++ > 0 )
+    {
+        return true;
+    }
+
+    // Count it before the compensation worker is linked, so the retire check sees the raised bound.
+    m_blocked_worker_count.fetch_add( 1 );
+    std::unique_lock<std::recursive_mutex> locker( m_mutex );
+    if( m_idle_head )
+    {
+        // The one woken first stands by for this blocker, do not retire it as a long idle one.
+        m_idle_head->m_idle_since = steady_now();
+    }
+    else
+    {
+        if( m_worker_count.load() >= get_worker_limit() )
+        {
+            return true;
+        }
+
+        LogUtilDebug() << "A worker is going to block, add a compensation one.";
+        add_worker();
+        m_compensation_count.fetch_add( 1, std::memory_order_relaxed );
+    }
+    locker.unlock();
+
+    // Hand the waiting ones to it or a parked one, modules need to be locked without m_mutex.
+    dispatch_backlog();
+    dispatch_ready_modules();
+    return true;
+}
+
+void thread_manager::leave_blocking_region()
+{
+    if( --s_blocking_depth > 0 )
+    {
+        return;
+    }
+    m_blocked_worker_count.fetch_sub( 1 );
+}
+
+void thread_manager::register_autoscale_timer()
+{
+    auto _timer_module = std::dynamic_pointer_cast< timer_module >( framework_manager::get_instance()
+        .get_module_manager().get_module( abstract_module::s_timer_module_name ) );
+    if( !_timer_module )
+    {
+        LogUtilError() << "No timer module, worker pool autoscaler is disabled.";
+        return;
+    }
+
+    auto timer_cb = [this]( uint32_t, std::string )->bool
+    {
+        autoscale();
+        return false;
+    };
+    m_schedule_timer_id = _timer_module->register_timer( timer_cb,
+        std::chrono::duration_cast< std::chrono::milliseconds >(
+            std::chrono::nanoseconds( m_autoscale_interval.load() ) ) );
+    LogUtilInfo() << "schedule timer registered.";
+}
+
+void thread_manager::check_task_wait_time( int64_t a_enqueue_time )
+{
+    int64_t now = steady_now();
+    int64_t wait_time = now - a_enqueue_time;
+    int64_t observed_wait = m_max_observed_wait.load( std::memory_order_relaxed );
+    while( wait_time > observed_wait &&
+        !m_max_observed_wait.compare_exchange_weak( observed_wait, wait_time, std::memory_order_relaxed ) )
+    {
+    }
+
+    int64_t max_task_wait_time = m_max_task_wait_time.load( std::memory_order_relaxed );
+    if( wait_time <= max_task_wait_time ||
+        m_worker_count.load( std::memory_order_relaxed ) >= get_worker_limit() )
+    {
+        return;
+    }
+
+    // At most one new worker in a wait period, let the last one take effect first.
+    int64_t last_grow_time = m_last_grow_time.load( std::memory_order_relaxed );
+    if( now - last_grow_time < max_task_wait_time ||
+        !m_last_grow_time.compare_exchange_strong( last_grow_time, now ) )
+    {
+        return;
+    }
+
+    std::lock_guard<std::recursive_mutex> locker( m_mutex );
+    if( m_worker_count.load() < get_worker_limit() )
+    {
+        LogUtilDebug() << "A task waited " << wait_time / 1000000 << "ms for a worker, add one.";
+        add_worker();
+    }
+}
+
+abstract_worker* thread_manager::find_idle_worker()
+{
+    if( !m_idle_head )
+    {
+        schedule_workers();
+        if( !m_idle_head )
+        {
+            return nullptr;
+        }
+    }
+
+    // Do not wake a parked one beyond the bound, see push_idle_worker.
+    if( is_beyond_worker_limit( 1 ) )
+    {
+        return nullptr;
+    }
+
+    abstract_worker* worker = m_idle_head;
+    unlink_idle_worker( worker );
+    dismiss_long_idle_worker();
+    return worker;
+}
+
+abstract_worker* thread_manager::find_idle_worker( module_task_cb const& a_task_cb )
+{
+    if( is_beyond_worker_limit( 1 ) )
+    {
+        return nullptr;
+    }
+
+    int32_t cpu = a_task_cb.m_pinned_cpu.load( std::memory_order_relaxed );
+    int32_t node = cpu >= 0 ? get_cpu_numa_node( static_cast< uint32_t >( cpu ) ) :
+        a_task_cb.m_numa_node.load( std::memory_order_relaxed );
+    if( cpu >= 0 || ( node >= 0 && m_numa_nodes.size() > 1 ) )
+    {
+        // Prefer the one on the CPU, then one of the same node. The idle list is short.
+        abstract_worker* local_worker = nullptr;
+        for( abstract_worker* worker = m_idle_head; worker; worker = worker->m_next_idle )
+        {
+            if( cpu >= 0 && worker->m_pinned_cpu == cpu )
+            {
+                local_worker = worker;
+                break;
+            }
+
+            if( !local_worker && worker->m_numa_node.load( std::memory_order_relaxed ) == node )
+            {
+                local_worker = worker;
+            }
+        }
+
+        if( local_worker )
+        {
+            unlink_idle_worker( local_worker );
+            dismiss_long_idle_worker();
+            return local_worker;
+        }
+    }
+
+    // Spill to any worker, it is the last resort.
+    return find_idle_worker();
+}
+
+void thread_manager::assign_work
+    (
+    abstract_worker* a_worker,
+    std::shared_ptr<abstract_task> a_task
+    )
+{
+    a_worker->post_task( std::move( a_task ) );
+    unlink_idle_worker( a_worker );
+}
+
+void thread_manager::assign_work
+    (
+    abstract_worker* a_worker,
+    std::vector<std::shared_ptr<abstract_task>> a_tasks
+    )
+{
+    a_worker->post_task( std::move( a_tasks ) );
+    unlink_idle_worker( a_worker );
+}
+
+void thread_manager::dismiss_long_idle_worker()
+{
+    // The worker occupying the thread called run is not a pool one.
+    abstract_worker* caller_worker = m_caller_worker.load();
+    uint32_t worker_count = m_worker_count.load();
+    if( caller_worker && worker_count > 0 )
+    {
+        --worker_count;
+    }
+
+    if( !m_idle_tail || worker_count <= m_min_worker_num.load( std::memory_order_relaxed ) )
+    {
+        return;
+    }
+
+    /**
+     * The bound is raised by the blocking workers, the same as growing. Within it, compensation
+     * workers stay like the others. Beyond it, the blockers have left, retire the ones kept idle
+     * for the idle retire time. A timer blocks again soon, it should find one parked instead
+     * of adding a new one.
+     */
+    int64_t now = steady_now();
+    uint32_t worker_limit = m_max_worker_num.load( std::memory_order_relaxed ) + m_blocked_worker_count.load();
+    bool beyond_limit = worker_count > worker_limit;
+    if( !beyond_limit )
+    {
+        if( now - m_retire_period_start < m_idle_retire_time.load( std::memory_order_relaxed ) )
+        {
+            return;
+        }
+
+        /**
+         * Retire only if more than one worker kept idle for the whole period, one spare
+         * worker is kept for the next burst. So the pool does not shrink and grow
+         * again and again when the load swings.
+         */
+        bool has_spare = m_idle_low_water > 1;
+        m_retire_period_start = now;
+        m_idle_low_water = m_idle_worker_count.load();
+        if( !has_spare )
+        {
+            return;
+        }
+    }
+
+    // The tail of the idle list is the one idle for the longest time.
+    // Nobody can assign work to it once it leaves the idle list.
+    abstract_worker* worker = m_idle_tail;
+    if( worker == caller_worker )
+    {
+        worker = worker->m_prev_idle;
+        if( !worker )
+        {
+            return;
+        }
+    }
+
+    if( beyond_limit && now - worker->m_idle_since < m_idle_retire_time.load( std::memory_order_relaxed ) )
+    {
+        return;
+    }
+    unlink_idle_worker( worker );
+    worker->exit_later();
+    m_retire_count.fetch_add( 1, std::memory_order_relaxed );
+}
+
+thread_manager::module_task_cb& thread_manager::get_module_cb( std::string const& a_module )
+{
+    {
+        std::shared_lock<std::shared_mutex> locker( m_modules_mutex );
+        auto it = m_modules_shcedule.find( a_module );
+        if( it != m_modules_shcedule.end() )
+        {
+            return *( it->second );
+        }
+    }
+
+    if( !a_module.empty() )
+    {
+        LogUtilError() << "Such module has not registered: " << a_module;
+    }
+
+    // Control blocks are never erased, so the reference keeps valid after unlock.
+    std::lock_guard<std::shared_mutex> locker( m_modules_mutex );
+    return create_module_cb( a_module );
+}
+
+thread_manager::module_task_cb& thread_manager::get_module_cb( module_id a_module )
+{
+    std::atomic<module_task_cb*>* slot = m_module_cbs.find( a_module );
+    module_task_cb* cb = slot ? slot->load( std::memory_order_acquire ) : nullptr;
+    if( cb )
+    {
+        return *cb;
+    }
+    return get_module_cb( module_name_registry::get_name( a_module ) );
+}
+
+thread_manager::module_task_cb& thread_manager::create_module_cb( std::string const& a_module )
+{
+    std::unique_ptr<module_task_cb>& cb = m_modules_shcedule[a_module];
+    if( !cb )
+    {
+        cb = std::make_unique<module_task_cb>();
+        cb->module_name = a_module;
+        cb->m_module_id = module_name_registry::intern( a_module );
+        m_module_cbs.get( cb->m_module_id ).store( cb.get(), std::memory_order_release );
+    }
+    return *cb;
+}
+
+void thread_manager::schedule_sequence_task
+    (
+    module_task_cb& a_task_cb,
+    std::shared_ptr<abstract_task> a_task
+    )
+{
+    std::unique_lock<std::mutex> locker( a_task_cb.m_mutex );
+    if( a_task_cb.m_executing_worker && a_task_cb.pending_tasks.empty() && !is_over_share( a_task_cb ) )
+    {
+        a_task_cb.m_executing_worker->post_task( std::move( a_task ) );
+        return;
+    }
+
+    // Deferred tasks of a running module wait in pending_tasks until its worker releases it.
+    bool already_ready = !a_task_cb.pending_tasks.empty() || a_task_cb.m_executing_worker;
+    insert_pending_task( a_task_cb, std::move( a_task ) );
+    if( !already_ready )
+    {
+        make_module_runnable( a_task_cb, locker );
+    }
+}
+
+void thread_manager::schedule_sequence_tasks
+    (
+    module_task_cb& a_task_cb,
+    std::vector<std::shared_ptr<abstract_task>> a_tasks
+    )
+{
+    std::unique_lock<std::mutex> locker( a_task_cb.m_mutex );
+    if( a_task_cb.m_executing_worker && a_task_cb.pending_tasks.empty() && !is_over_share( a_task_cb ) )
+    {
+        a_task_cb.m_executing_worker->post_task( std::move( a_tasks ) );
+        return;
+    }
+
+    bool already_ready = !a_task_cb.pending_tasks.empty() || a_task_cb.m_executing_worker;
+    for( auto& ele : a_tasks )
+    {
+        insert_pending_task( a_task_cb, std::move( ele ) );
+    }
+
+    if( !already_ready )
+    {
+        make_module_runnable( a_task_cb, locker );
+    }
+}
+
+void thread_manager::insert_pending_task
+    (
+    module_task_cb& a_task_cb,
+    std::shared_ptr<abstract_task> a_task
+    )
+{
+    // Cached tasks must be executed before this one, unless they have lower priority.
+    if( a_task_cb.pending_tasks.empty() )
+    {
+        a_task_cb.m_ready_time = steady_now();
+        a_task_cb.pending_tasks.push_back( std::move( a_task ) );
+        return;
+    }
+
+    task_priority priority = a_task->get_priority();
+    if( a_task_cb.pending_tasks.back()->get_priority() <= priority )
+    {
+        a_task_cb.pending_tasks.push_back( std::move( a_task ) );
+    }
+    else
+    {
+        auto it = std::find_if( a_task_cb.pending_tasks.begin(), a_task_cb.pending_tasks.end(),
+            [priority]( std::shared_ptr<abstract_task> const& a_pending )
+            {
+                return a_pending->get_priority() > priority;
+            } );
+        a_task_cb.pending_tasks.insert( it, std::move( a_task ) );
+    }
+}
+
+void thread_manager::make_module_runnable
+    (
+    module_task_cb& a_task_cb,
+    std::unique_lock<std::mutex>& a_locker
+    )
+{
+    if( claim_worker_for_module( a_task_cb ) )
+    {
+        return;
+    }
+
+    // There are maybe no more workers. So we cache the tasks.
+    push_ready_module( a_task_cb );
+    a_locker.unlock();
+
+    /**
+     * Pairs with the fence in push_idle_worker: if a worker turned idle meanwhile,
+     * either it sees this module ready or we see it here.
+     */
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if( m_idle_worker_count.load( std::memory_order_relaxed ) > 0 )
+    {
+        dispatch_ready_modules();
+    }
+}
+
+bool thread_manager::claim_worker_for_module( module_task_cb& a_task_cb )
+{
+    abstract_worker* worker = nullptr;
+    {
+        std::lock_guard<std::recursive_mutex> locker( m_mutex );
+        worker = find_idle_worker( a_task_cb );
+        if( !worker )
+        {
+            return false;
+        }
+        record_numa_claim( worker, a_task_cb );
+        bind_worker_to_module( worker, a_task_cb );
+        worker->m_owned_modules.push_back( &a_task_cb );
+        assign_work( worker, take_pending_batch( a_task_cb ) );
+    }
+
+    a_task_cb.m_executing_worker = worker;
+    return true;
+}
+
+void thread_manager::schedule_immediately_task
+    (
+    std::shared_ptr<abstract_task> a_task,
+    module_id a_module
+    )
+{
+    s_thread_module_owner = a_module;
+    auto_guard guard( [this]() { s_thread_module_owner = s_no_module_id; } );
+    if( s_event_envelope_kind == a_task->get_task_kind() )
+    {
+        framework_manager::get_instance().get_module_manager().schedule_task( std::move( a_task ) );
+        return;
+    }
+
+    std::shared_ptr<abstract_module> detail_module = framework_manager::get_instance().get_module_manager()
+        .get_module_by_id( a_module );
+    if( detail_module )
+    {
+        detail_module->handle_task( std::move( a_task ) );
+    }
+    else
+    {
+        LogUtilError() << "No such module: " << module_name_registry::get_name( a_module );
+    }
     return;
 }
 
@@ -486,16 +1714,52 @@ void thread_manager::schedule_concurrently_task
     std::shared_ptr<abstract_task> a_task
     )
 {
-    std::shared_ptr<abstract_worker> worker;
-    worker = find_idle_worker();
-    if( worker )
+    a_task->m_enqueue_time = steady_now();
+    push_concurrently_task( std::move( a_task ), s_current_worker );
+    dispatch_concurrently_tasks();
+}
+
+void thread_manager::schedule_concurrently_tasks
+    (
+    std::vector<std::shared_ptr<abstract_task>> a_tasks
+    )
+{
+    int64_t now = steady_now();
+    abstract_worker* current_worker = s_current_worker;
+    for( auto& ele : a_tasks )
     {
-        assign_work( worker, a_task );
+        ele->m_enqueue_time = now;
+        push_concurrently_task( std::move( ele ), current_worker );
     }
-    else
+    dispatch_concurrently_tasks();
+}
+
+void thread_manager::push_concurrently_task
+    (
+    std::shared_ptr<abstract_task> a_task,
+    abstract_worker* a_current_worker
+    )
+{
+    /**
+     * A normal priority task without deadline posted by a worker goes to that worker's
+     * local queue, other workers will steal it if they have nothing to do. Otherwise it
+     * goes to the backlog lane of its priority.
+     */
+    if( a_task->get_priority() != task_priority::normal || a_task->has_deadline() || !a_current_worker ||
+        !a_current_worker->push_local_task( a_task ) )
+    {
+        push_backlog_task( std::move( a_task ) );
+    }
+}
+
+void thread_manager::dispatch_concurrently_tasks()
+{
+    // Pairs with the fence in push_idle_worker.
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if( m_idle_worker_count.load( std::memory_order_relaxed ) > 0 ||
+        m_worker_count.load( std::memory_order_relaxed ) < m_min_worker_num.load( std::memory_order_relaxed ) )
     {
-        //There is no worker to do our work current.
-        m_work_need_assign.push_back( a_task );
+        dispatch_backlog();
     }
 }
 
@@ -504,8 +1768,15 @@ void thread_manager::schedule_handler_task
     std::shared_ptr<abstract_task> a_task
     )
 {
-    std::string const& _module = a_task->get_target_module();
-    auto detail_module = framework_manager::get_instance().get_module_manager().get_module( _module );
+    std::shared_ptr<abstract_module> detail_module = framework_manager::get_instance().get_module_manager()
+        .get_module_by_id( a_task->get_target_module_id() );
+    if( !detail_module )
+    {
+        LogUtilError() << "No such module: " << a_task->get_target_module();
+        schedule_concurrently_task( std::move( a_task ) );
+        return;
+    }
+
     auto handler = detail_module->get_task_handler();
     if( handler )
     {
@@ -513,12 +1784,50 @@ void thread_manager::schedule_handler_task
     }
     else
     {
-        LogUtilError() << "module " << _module << " does not have a task handler."
+        LogUtilError() << "module " << a_task->get_target_module() << " does not have a task handler."
             " but it is module_type is handler_shchedule.";
         schedule_concurrently_task( std::move( a_task ) );
     }
 }
 
+void thread_manager::schedule_dedicated_task
+    (
+    module_task_cb& a_task_cb,
+    std::shared_ptr<abstract_task> a_task
+    )
+{
+    std::lock_guard<std::mutex> locker( a_task_cb.m_mutex );
+    if( !a_task_cb.m_dedicated_worker )
+    {
+        start_dedicated_worker( a_task_cb );
+    }
+    a_task_cb.m_dedicated_worker->post_task( std::move( a_task ) );
+}
+
+void thread_manager::start_dedicated_worker( module_task_cb& a_task_cb )
+{
+    std::shared_ptr<abstract_worker> worker = std::make_shared<thread_worker>();
+    worker->m_dedicated_module = &a_task_cb;
+    worker->set_dedicated( a_task_cb.m_busy_poll.load() );
+    int32_t cpu = a_task_cb.m_pinned_cpu.load();
+    if( cpu >= 0 )
+    {
+        worker->m_pinned_cpu = cpu;
+        worker->set_affinity( { static_cast< uint32_t >( cpu ) } );
+    }
+    worker->set_worker_name( a_task_cb.module_name );
+    worker->run( worker, false );
+    a_task_cb.m_dedicated_worker = std::move( worker );
+    LogUtilInfo() << "started dedicated thread for " << a_task_cb.module_name;
+}
+
+void thread_manager::stop_dedicated_worker( module_task_cb& a_task_cb )
+{
+    // Its remained tasks are posted again when it quits, as the module's new type.
+    a_task_cb.m_dedicated_worker->exit_later();
+    a_task_cb.m_dedicated_worker.reset();
+}
+
 std::shared_ptr<abstract_worker> thread_manager::make_worker()
 {
     std::string worker_name{ "worker" };
@@ -526,8 +1835,269 @@ std::shared_ptr<abstract_worker> thread_manager::make_worker()
     std::shared_ptr<thread_worker> thread_worker_;
     thread_worker_ = std::make_shared<thread_worker>();
     thread_worker_->set_worker_name( worker_name );
+
+    std::lock_guard<std::shared_mutex> locker( m_stealable_mutex );
+    m_stealable_workers.push_back( thread_worker_ );
     return thread_worker_;
 }
 
+void thread_manager::push_backlog_task( std::shared_ptr<abstract_task> a_task )
+{
+    if( 0 == a_task->m_enqueue_time )
+    {
+        a_task->m_enqueue_time = steady_now();
+    }
+
+    backlog_lane& lane = m_backlog[static_cast< size_t >( a_task->get_priority() )];
+    if( a_task->has_deadline() )
+    {
+        std::lock_guard<std::mutex> locker( lane.m_deadline_mutex );
+        lane.m_deadline_heap.push_back( std::move( a_task ) );
+        std::push_heap( lane.m_deadline_heap.begin(), lane.m_deadline_heap.end(), later_deadline );
+        lane.m_deadline_size.fetch_add( 1 );
+        return;
+    }
+
+    if( lane.m_work_need_assign.try_push( std::move( a_task ) ) )
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> locker( lane.m_overflow_mutex );
+    lane.m_work_overflow.push_back( std::move( a_task ) );
+    lane.m_overflow_size.fetch_add( 1 );
+}
+
+std::shared_ptr<abstract_task> thread_manager::pop_backlog_task()
+{
+    /**
+     * Higher lanes go first, except that some pops start at a lower lane. So a flood
+     * of higher priority tasks cannot starve the lower ones.
+     */
+    uint32_t pop_count = s_backlog_pop_count++;
+    size_t first_lane = static_cast< size_t >( task_priority::high );
+    if( pop_count % s_background_lane_share == s_background_lane_share - 1 )
+    {
+        first_lane = static_cast< size_t >( task_priority::background );
+    }
+    else if( pop_count % s_normal_lane_share == s_normal_lane_share - 1 )
+    {
+        first_lane = static_cast< size_t >( task_priority::normal );
+    }
+
+    std::shared_ptr<abstract_task> task = pop_backlog_task( first_lane );
+    for( size_t lane = 0; lane < s_task_priority_count && !task; ++lane )
+    {
+        if( lane != first_lane )
+        {
+            task = pop_backlog_task( lane );
+        }
+    }
+    return task;
+}
+
+std::shared_ptr<abstract_task> thread_manager::pop_backlog_task( size_t a_lane )
+{
+    backlog_lane& lane = m_backlog[a_lane];
+    std::shared_ptr<abstract_task> task;
+    do
+    {
+        task.reset();
+        if( lane.m_deadline_size.load() > 0 )
+        {
+            std::lock_guard<std::mutex> locker( lane.m_deadline_mutex );
+            if( !lane.m_deadline_heap.empty() )
+            {
+                std::pop_heap( lane.m_deadline_heap.begin(), lane.m_deadline_heap.end(), later_deadline );
+                task = std::move( lane.m_deadline_heap.back() );
+                lane.m_deadline_heap.pop_back();
+                lane.m_deadline_size.fetch_sub( 1 );
+            }
+        }
+
+        if( !task && !lane.m_work_need_assign.try_pop( task ) && lane.m_overflow_size.load() > 0 )
+        {
+            std::lock_guard<std::mutex> locker( lane.m_overflow_mutex );
+            if( !lane.m_work_overflow.empty() )
+            {
+                task = std::move( lane.m_work_overflow.front() );
+                lane.m_work_overflow.pop_front();
+                lane.m_overflow_size.fetch_sub( 1 );
+            }
+        }
+    } while( task && drop_expired_task( task ) );
+
+    if( task )
+    {
+        check_task_wait_time( task->m_enqueue_time );
+    }
+    return task;
+}
+
+std::shared_ptr<abstract_task> thread_manager::pop_high_priority_task()
+{
+    backlog_lane& lane = m_backlog[static_cast< size_t >( task_priority::high )];
+    if( lane.m_work_need_assign.empty() && 0 == lane.m_overflow_size.load( std::memory_order_relaxed ) &&
+        0 == lane.m_deadline_size.load( std::memory_order_relaxed ) )
+    {
+        return nullptr;
+    }
+
+    // Keep the lane shares, workers take most backlog tasks through here under a high flood.
+    return pop_backlog_task();
+}
+
+size_t thread_manager::backlog_size_approx()const
+{
+    size_t size = 0;
+    for( backlog_lane const& lane : m_backlog )
+    {
+        size += lane.m_work_need_assign.size_approx() + lane.m_overflow_size.load( std::memory_order_relaxed ) +
+            lane.m_deadline_size.load( std::memory_order_relaxed );
+    }
+    return size;
+}
+
+std::shared_ptr<abstract_task> thread_manager::steal_task( abstract_worker* a_thief )
+{
+    std::shared_ptr<abstract_task> task;
+    int32_t thief_node = a_thief ? a_thief->m_numa_node.load( std::memory_order_relaxed ) : -1;
+    bool numa_aware = thief_node >= 0 && m_numa_nodes.size() > 1;
+    bool remote = false;
+    {
+        // Steal from workers of the same node first, remote ones are the last resort.
+        std::shared_lock<std::shared_mutex> locker( m_stealable_mutex );
+        size_t count = m_stealable_workers.size();
+        uint32_t start = s_next_steal_victim++;
+        for( int pass = numa_aware ? 0 : 1; pass < 2 && !task; ++pass )
+        {
+            remote = numa_aware && pass == 1;
+            for( size_t i = 0; i < count && !task; ++i )
+            {
+                auto& victim = m_stealable_workers[( start + i ) % count];
+                bool same_node = victim->m_numa_node.load( std::memory_order_relaxed ) == thief_node;
+                if( victim.get() != a_thief && ( !numa_aware || same_node != remote ) )
+                {
+                    task = victim->steal_task();
+                }
+            }
+        }
+    }
+
+    // Adding a worker needs m_stealable_mutex, so check it after unlocked.
+    if( task )
+    {
+        if( numa_aware && static_cast< size_t >( thief_node ) < m_numa_nodes.size() )
+        {
+            numa_node& node = *m_numa_nodes[thief_node];
+            ( remote ? node.m_remote_steal_count : node.m_local_steal_count ).fetch_add( 1, std::memory_order_relaxed );
+        }
+        check_task_wait_time( task->m_enqueue_time );
+    }
+    return task;
+}
+
+void thread_manager::dispatch_backlog()
+{
+    std::lock_guard<std::recursive_mutex> locker( m_mutex );
+    while( true )
+    {
+        if( !m_idle_head )
+        {
+            schedule_workers();
+            if( !m_idle_head )
+            {
+                return;
+            }
+        }
+
+        std::shared_ptr<abstract_task> task = pop_backlog_task();
+        if( !task )
+        {
+            task = steal_task( nullptr );
+        }
+
+        if( !task )
+        {
+            return;
+        }
+
+        abstract_worker* worker = find_idle_worker();
+        if( !worker )
+        {
+            push_backlog_task( std::move( task ) );
+            return;
+        }
+        assign_work( worker, std::move( task ) );
+    }
+}
+
+void thread_manager::link_idle_worker( abstract_worker* a_worker )
+{
+    if( a_worker->m_pool_state == abstract_worker::pool_state::idle )
+    {
+        return;
+    }
+
+    if( a_worker->m_pool_state == abstract_worker::pool_state::working )
+    {
+        --m_working_worker_count;
+    }
+    else
+    {
+        m_worker_count.fetch_add( 1 );
+    }
+
+    // Push front, the most recently idle worker has the warmest cache.
+    a_worker->m_pool_state = abstract_worker::pool_state::idle;
+    a_worker->m_idle_since = steady_now();
+    a_worker->m_prev_idle = nullptr;
+    a_worker->m_next_idle = m_idle_head;
+    if( m_idle_head )
+    {
+        m_idle_head->m_prev_idle = a_worker;
+    }
+    else
+    {
+        m_idle_tail = a_worker;
+    }
+    m_idle_head = a_worker;
+    m_idle_worker_count.fetch_add( 1 );
+}
+
+bool thread_manager::unlink_idle_worker( abstract_worker* a_worker )
+{
+    if( a_worker->m_pool_state != abstract_worker::pool_state::idle )
+    {
+        return false;
+    }
+
+    if( a_worker->m_prev_idle )
+    {
+        a_worker->m_prev_idle->m_next_idle = a_worker->m_next_idle;
+    }
+    else
+    {
+        m_idle_head = a_worker->m_next_idle;
+    }
+
+    if( a_worker->m_next_idle )
+    {
+        a_worker->m_next_idle->m_prev_idle = a_worker->m_prev_idle;
+    }
+    else
+    {
+        m_idle_tail = a_worker->m_prev_idle;
+    }
+
+    a_worker->m_prev_idle = nullptr;
+    a_worker->m_next_idle = nullptr;
+    a_worker->m_pool_state = abstract_worker::pool_state::working;
+    ++m_working_worker_count;
+    uint32_t idle_count = m_idle_worker_count.fetch_sub( 1 ) - 1;
+    m_idle_low_water = std::min( m_idle_low_water, idle_count );
+    return true;
+}
+
 }
 
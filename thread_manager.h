@@ -23,45 +23,237 @@
 #pragma once
 #include "abstract_worker.h"
 #include "abstract_module.h"
+#include "executable_task.h"
+#include "module_id.h"
+#include "mpmc_queue.h"
+#include <atomic>
+#include <chrono>
+#include <list>
 #include <vector>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 namespace framework
 {
 
+/**
+ * A module's share of CPU time is proportional to its weight.
+ */
+constexpr uint32_t s_default_module_weight = 1024;
+
+/**
+ * Module task schedule control block. Each module has its own lock, so
+ * posting tasks to different modules never contend with each other.
+ * If pending_tasks is not empty and there is no executing worker, the control
+ * block is in thread manager's ready module queue. If it has both, the module
+ * had more than a batch of tasks or used more than its share of CPU time, its
+ * worker releases it when the worker runs out of posted tasks.
+ */
+struct module_task_cb
+{
+    std::mutex m_mutex; // Protect the members below except module_type_value
+    std::string module_name;
+    module_id m_module_id = s_no_module_id;
+    std::atomic<abstract_module::module_type> module_type_value = abstract_module::module_type::sequence_executing;
+    std::list<std::shared_ptr<abstract_task>> pending_tasks;
+    abstract_worker* m_executing_worker = nullptr; // Reset before the worker leaves the pool
+    bool m_ready = false; // In the ready module queue, maybe a stale one
+    int64_t m_ready_time = 0; // When pending_tasks became not empty, in steady clock nanoseconds
+    std::atomic_uint64_t m_expired_task_count = 0; // Tasks dropped because of expired
+    std::atomic_int32_t m_pinned_cpu = -1; // Run the tasks on this CPU, -1 means any
+    std::atomic_int32_t m_numa_node = -1; // Prefer workers of this NUMA node, -1 means any
+    std::atomic_uint32_t m_weight = s_default_module_weight;
+    std::atomic_int64_t m_vruntime = 0; // CPU time scaled by weight, in nanoseconds. The least one runs first
+    std::atomic_int64_t m_cpu_time = 0; // Consumed CPU time, in nanoseconds
+    std::shared_ptr<abstract_worker> m_dedicated_worker; // Own thread of a dedicated thread module
+    std::atomic_bool m_busy_poll = false; // The dedicated worker spins instead of parking
+};
+
 class FRAMEWORK_EXPORT thread_manager
 {
 
 public:
 
+    using module_task_cb = framework::module_task_cb;
+
+    /**
+     * Worker pool bounds and resizing thresholds. Zero means the default value.
+     */
+    struct pool_config
+    {
+        /**
+         * The pool starts with so many workers and never shrinks below it.
+         * Default is s_default_min_worker_num.
+         */
+        uint32_t m_min_worker_num = 0;
+
+        /**
+         * The pool never grows beyond it. Default is std::thread::hardware_concurrency(),
+         * at least s_default_max_worker_num. The worker occupying the thread called
+         * run is not counted.
+         */
+        uint32_t m_max_worker_num = 0;
+
+        /**
+         * The queue latency target. Add a worker if a task waited longer than this
+         * for a worker. Default is s_max_task_time_out ms.
+         */
+        std::chrono::milliseconds m_max_task_wait_time{ 0 };
+
+        /**
+         * Retire a worker only if spare workers kept idle for this long.
+         * Default is s_default_idle_retire_time.
+         */
+        std::chrono::milliseconds m_idle_retire_time{ 0 };
+
+        /**
+         * How often the autoscaler samples the pool. Default is s_default_autoscale_interval.
+         */
+        std::chrono::milliseconds m_autoscale_interval{ 0 };
+
+        /**
+         * Workers only run on these CPUs, empty means all CPUs. Only applies to the
+         * workers started after it is set.
+         */
+        std::vector<uint32_t> m_worker_cpus;
+
+        /**
+         * Pin each worker to one CPU of m_worker_cpus in turn, instead of letting
+         * them float across all of m_worker_cpus.
+         */
+        bool m_pin_each_worker = false;
+    };
+
+    /**
+     * Worker pool counters, for tuning pool_config under production load.
+     * The sampled ones are the values at the last autoscaler sample.
+     */
+    struct pool_statistics
+    {
+        uint32_t m_worker_num = 0;
+        uint32_t m_idle_worker_num = 0;
+        size_t m_backlog_length = 0; // Sampled. Tasks and modules waiting for a worker
+        std::chrono::microseconds m_oldest_wait_time{ 0 }; // Sampled. The longest waiting one
+        double m_utilization = 0; // Sampled. Working workers / all workers
+        uint64_t m_sample_count = 0;
+        uint64_t m_latency_miss_count = 0; // Samples which exceeded the latency target
+        uint64_t m_grow_count = 0; // Workers added
+        uint64_t m_grow_blocked_count = 0; // Need more workers but the pool is full
+        uint64_t m_retire_count = 0; // Workers retired
+        uint64_t m_expired_task_count = 0; // Tasks dropped because of expired, all modules
+        uint32_t m_blocked_worker_num = 0; // Workers blocking inside a blocking_guard
+        uint64_t m_compensation_count = 0; // Workers added because others were blocking
+    };
+
     /**
-     * Module task schedule control block
+     * Scheduling decisions of one NUMA node.
      */
-    struct module_task_cb
+    struct numa_node_statistics
     {
-        std::string module_name;
-        abstract_module::module_type module_type_value = abstract_module::module_type::sequence_executing;
-        std::list<std::shared_ptr<abstract_task>> pending_tasks;
-        std::shared_ptr<abstract_worker> m_executing_worker;
+        std::vector<uint32_t> m_cpus;
+        uint32_t m_worker_num = 0;
+        uint64_t m_local_claim_count = 0; // Modules placed on this node ran on its workers
+        uint64_t m_remote_claim_count = 0; // Modules placed on this node spilled to remote workers
+        uint64_t m_local_steal_count = 0; // Its workers stole tasks from workers of this node
+        uint64_t m_remote_steal_count = 0; // Its workers stole tasks from remote workers
     };
 
     /**
-     * Max thread number. That is thread manager can manage how many threads.
+     * Starvation protection of the backlog lanes. One in s_normal_lane_share backlog
+     * pops serves the normal lane first, and one in s_background_lane_share serves
+     * the background lane first.
      */
-    constexpr static uint8_t s_max_worker_num = 6;
+    constexpr static uint32_t s_normal_lane_share = 4;
+    constexpr static uint32_t s_background_lane_share = 16;
+
+    /**
+     * A module is deferred only if its virtual runtime is ahead of the least served
+     * ready module by more than this. Avoids bouncing modules between workers.
+     */
+    constexpr static std::chrono::milliseconds s_fair_share_granularity{ 2 };
+
+    /**
+     * A worker takes at most so many pending tasks of a module at once, then the
+     * module competes with others again.
+     */
+    constexpr static uint32_t s_max_sequence_batch = 64;
+
+    constexpr static uint32_t s_default_min_worker_num = 2;
+
+    /**
+     * The least default bound, a host with few CPUs still has workers for the
+     * tasks waiting on a timer or I/O.
+     */
+    constexpr static uint32_t s_default_max_worker_num = 6;
+
+    constexpr static std::chrono::milliseconds s_default_idle_retire_time{ 10000 };
+
+    constexpr static std::chrono::milliseconds s_default_autoscale_interval{ 100 };
 
     /**
      * A task can wait for executing time is s_max_task_time_out ms.
      */
     constexpr static uint8_t s_max_task_time_out = 20;
 
+    /**
+     * How many concurrently executing tasks can wait in the lock free backlog.
+     * If the backlog is full, the task will be cached in an overflow list.
+     */
+    constexpr static size_t s_backlog_capacity = 4096;
+
+    thread_manager();
+
     /**
      * Run thread pool
      */
     void run( bool a_occupy_current_thread = false );
 
-    void post_task( std::function<void()> a_tsk );
+    /**
+     * Stop thread pool. Let the workers finish the queued tasks until a_deadline,
+     * then cancel the remained ones, including the ones posted from now on. Join
+     * all workers, run can be called again after it. A task running past a_deadline
+     * delays it. Can not be called in a worker. Return how many tasks were cancelled.
+     */
+    size_t stop( std::chrono::steady_clock::time_point a_deadline );
+
+    /**
+     * Change the worker pool bounds. Can be called before or after run.
+     */
+    void set_pool_config( pool_config const& a_config );
+
+    /**
+     * Return the pool bounds in use, default values are resolved.
+     */
+    pool_config get_pool_config()const;
+
+    pool_statistics get_pool_statistics()const;
+
+    /**
+     * Statistics of each NUMA node, indexed by node id.
+     */
+    std::vector<numa_node_statistics> get_numa_statistics()const;
+
+    /**
+     * Post a callable into thread pool, it is stored in the task without wrapping
+     * again. The result of the callable is ignored. An empty std::function or a
+     * null function pointer is not posted.
+     */
+    template<typename fun_type, typename = std::enable_if_t<std::is_invocable_v<std::decay_t<fun_type>&>>>
+    void post_task( fun_type&& a_tsk )
+    {
+        if constexpr( std::is_constructible_v<bool, std::decay_t<fun_type>&> )
+        {
+            if( !a_tsk )
+            {
+                return;
+            }
+        }
+
+        auto tsk = make_task<executable_task>();
+        tsk->set_fun( std::forward<fun_type>( a_tsk ), abstract_module::get_task_runner_module_id() );
+        post_task( std::move( tsk ) );
+    }
 
     void post_delay_task
         (
@@ -85,6 +277,57 @@ public:
      */
     void push_idle_worker( std::shared_ptr<abstract_worker> a_worker );
 
+    /**
+     * Internal use. If there are high priority concurrently executing tasks in the backlog,
+     * take one, or a lower lane's one when that lane's share is due. A worker runs it
+     * before the tasks in its local queue. Return empty if the high lane is empty.
+     */
+    std::shared_ptr<abstract_task> pop_high_priority_task();
+
+    /**
+     * Internal use, see blocking_guard. The current worker is about to block, it does
+     * not count against the pool bound until leave_blocking_region. Add a compensation
+     * worker if no one is idle. Return false if not called in a pool worker.
+     */
+    bool enter_blocking_region();
+
+    /**
+     * Internal use. The current worker runs again, the extra workers retire once idle.
+     */
+    void leave_blocking_region();
+
+    /**
+     * Run a sequence executing module's tasks on a_cpu, for cache locality and
+     * predictable latency. The worker runs the module moves to a_cpu and stays
+     * there, so later it will be chosen for the module again. A dedicated thread
+     * module's own thread is bound to a_cpu. -1 cancels it.
+     */
+    void set_module_cpu( std::string const& a_module, int32_t a_cpu );
+
+    /**
+     * Place a sequence executing module on a NUMA node, near the memory it touches.
+     * Its tasks run on workers of a_node, and spill to a remote worker only if the
+     * node has no idle worker. -1 cancels it.
+     */
+    void set_module_numa_node( std::string const& a_module, int32_t a_node );
+
+    /**
+     * Let a dedicated thread module's own thread busy poll for tasks instead of
+     * parking. It takes a CPU fully, better to pin the module with set_module_cpu.
+     */
+    void set_module_busy_poll( std::string const& a_module, bool a_busy_poll );
+
+    /**
+     * Internal use. If a_task has expired, count it to its target module and return
+     * true, the caller should drop it instead of executing it.
+     */
+    bool drop_expired_task( std::shared_ptr<abstract_task> const& a_task );
+
+    /**
+     * How many tasks of a_module were dropped because of expired.
+     */
+    uint64_t get_expired_task_count( std::string const& a_module )const;
+
     /**
      * Register module types. Thread manager will schedule these tasks depend on module type.
      */
@@ -98,64 +341,257 @@ public:
 
     /**
      * Remove a worker from list. That is, that work is about to quit.
+     * a_unhandled_tasks, the tasks taken but not executed by a_worker, and the tasks
+     * still posted to it will be scheduled again, before the later tasks of the
+     * same modules.
+     */
+    void remove_worker
+        (
+        std::shared_ptr<abstract_worker> a_worker,
+        std::vector<std::shared_ptr<abstract_task>> a_unhandled_tasks
+        );
+
+    /**
+     * Give a_module a share of CPU time in proportion to a_weight, when modules compete
+     * for workers. A module not set has s_default_module_weight, so a_weight of twice
+     * s_default_module_weight gets twice the share of such module.
+     */
+    void set_module_weight( std::string const& a_module, uint32_t a_weight );
+
+    /**
+     * CPU time consumed by a_module's tasks.
      */
-    void remove_worker( std::shared_ptr<abstract_worker> a_worker );
+    std::chrono::nanoseconds get_module_cpu_time( std::string const& a_module )const;
+
+    /**
+     * Internal use. A worker spent a_time executing a task of a_module, charge it
+     * to the module. The task itself may have been handed over already.
+     */
+    void account_task_time( module_id a_module, std::chrono::nanoseconds a_time );
 
     static std::string const& get_current_thread_module_owner();
 
-    static void set_current_thread_module_owner( std::string a_module_name );
+    static void set_current_thread_module_owner( module_id a_module );
+
+    /**
+     * The worker running in current thread. nullptr if current thread is not a worker.
+     */
+    static abstract_worker* get_current_worker();
+
+    static void set_current_worker( abstract_worker* a_worker );
 
 private:
 
     /**
-     * Schedule threads.
-     * 1. Determine if new thread need added or not.
-     *   a. We need add new thread if there are many works need to do
-     *   b. We need add new thread if the first of task m_work_need_assign
-     *      have waiting for s_max_task_time_out ms.
-     * 2. Determine if a thread need remove or not.
-     * 3. Other things to do.
+     * Schedule threads. Add a worker if there is no idle one and the pool is
+     * below its minimum size. Beyond that, the pool grows by check_task_wait_time.
      */
     void schedule_workers();
 
+    /**
+     * Start a new worker and put it into the idle list. Must hold m_mutex.
+     */
+    void add_worker();
+
+    /**
+     * Periodic controller. Sample backlog length, the oldest waiting time and worker
+     * utilization, then add or retire workers against the queue latency target.
+     */
+    void autoscale();
+
+    /**
+     * The pool bound, raised by the number of blocking workers.
+     */
+    uint32_t get_worker_limit()const;
+
+    /**
+     * Whether the workers running tasks, the blocking ones included, would be more than
+     * get_worker_limit after waking a_waking idle ones.
+     */
+    bool is_beyond_worker_limit( uint32_t a_waking )const;
+
+    /**
+     * No task is waiting or running in the pool.
+     */
+    bool is_quiescent()const;
+
+    /**
+     * Drop the tasks left in the queues after all workers quit. Return how many.
+     */
+    size_t clear_queued_tasks();
+
+    /**
+     * Register the autoscale timer to timer module. Run in a worker.
+     */
+    void register_autoscale_timer();
+
+    /**
+     * A task or module waited from a_enqueue_time until now. Add a worker if it
+     * waited too long and the pool is not full.
+     */
+    void check_task_wait_time( int64_t a_enqueue_time );
+
     /**
      * Find a idle worker or allocate a new worker
      */
-    std::shared_ptr<abstract_worker> find_idle_worker();
+    abstract_worker* find_idle_worker();
+
+    /**
+     * Find a idle worker on a_task_cb's CPU or NUMA node, or any idle worker if there
+     * is no such one.
+     */
+    abstract_worker* find_idle_worker( module_task_cb const& a_task_cb );
+
+    /**
+     * Bind a new worker to the CPUs in pool config. Without pool config, spread the
+     * workers across the NUMA nodes. Must hold m_mutex.
+     */
+    void apply_worker_affinity( abstract_worker* a_worker );
+
+    /**
+     * The NUMA node of a_cpu, 0 if unknown.
+     */
+    int32_t get_cpu_numa_node( uint32_t a_cpu )const;
+
+    /**
+     * Count a_worker taking a_task_cb to its NUMA node statistics.
+     */
+    void record_numa_claim
+        (
+        abstract_worker const* a_worker,
+        module_task_cb const& a_task_cb
+        );
+
+    /**
+     * If a_task_cb is pinned to a CPU, move a_worker there. Only the thread holding
+     * a_worker calls it.
+     */
+    void bind_worker_to_module
+        (
+        abstract_worker* a_worker,
+        module_task_cb const& a_task_cb
+        );
 
     /**
      * assign a_task to a_worker
      */
     void assign_work
         (
-        std::shared_ptr<abstract_worker>& a_worker,
-        std::shared_ptr<abstract_task>& a_task
+        abstract_worker* a_worker,
+        std::shared_ptr<abstract_task> a_task
         );
 
     /**
-     * assign a_task to a_worker
+     * assign a_tasks to a_worker
      */
     void assign_work
         (
-        std::shared_ptr<abstract_worker>& a_worker,
-        std::list<std::shared_ptr<abstract_task>>& a_task
+        abstract_worker* a_worker,
+        std::vector<std::shared_ptr<abstract_task>> a_tasks
         );
 
     /**
-     * If there is a long idle worker, we need dismiss it and release some system resource
+     * If spare workers kept idle for a whole retire period, dismiss the longest idle
+     * one and release some system resource. Workers beyond the bound are dismissed
+     * at once, except the compensation ones. Must hold m_mutex.
      */
     void dismiss_long_idle_worker();
 
+    /**
+     * Find the module's control block, create one if not registered yet.
+     */
+    module_task_cb& get_module_cb( std::string const& a_module );
+
+    /**
+     * Same as above, but looks up the flat table first, which takes no lock.
+     */
+    module_task_cb& get_module_cb( module_id a_module );
+
+    /**
+     * Create the module's control block if need and publish it to m_module_cbs.
+     * Must hold m_modules_mutex exclusively.
+     */
+    module_task_cb& create_module_cb( std::string const& a_module );
+
     void schedule_sequence_task
         (
         module_task_cb& a_task_cb,
         std::shared_ptr<abstract_task> a_task
         );
 
+    /**
+     * Schedule some tasks of one sequence module, lock its control block only once.
+     */
+    void schedule_sequence_tasks
+        (
+        module_task_cb& a_task_cb,
+        std::vector<std::shared_ptr<abstract_task>> a_tasks
+        );
+
+    /**
+     * Add a_task into a_task_cb's pending tasks by priority. Must hold a_task_cb.m_mutex.
+     */
+    void insert_pending_task
+        (
+        module_task_cb& a_task_cb,
+        std::shared_ptr<abstract_task> a_task
+        );
+
+    /**
+     * a_task_cb just got pending tasks, hand it to an idle worker or make it ready.
+     * a_locker holds a_task_cb.m_mutex, it may be unlocked when returned.
+     */
+    void make_module_runnable
+        (
+        module_task_cb& a_task_cb,
+        std::unique_lock<std::mutex>& a_locker
+        );
+
+    /**
+     * Hand a_task_cb's pending tasks to an idle worker. Must hold a_task_cb.m_mutex.
+     * Return false if there is no worker can do it.
+     */
+    bool claim_worker_for_module( module_task_cb& a_task_cb );
+
+    /**
+     * Release the sequence modules a_worker finished, and give a_worker a module
+     * which is waiting for a worker. Return true if a_worker got work to do.
+     * Only a_worker's thread calls it.
+     */
+    bool assign_sequence_work( abstract_worker* a_worker );
+
+    /**
+     * Make a_task_cb runnable by the next idle worker. Must hold a_task_cb.m_mutex.
+     */
+    void push_ready_module( module_task_cb& a_task_cb );
+
+    /**
+     * Take the ready module with the least virtual runtime, it may be already claimed
+     * by someone else, check it again after locking it. Return nullptr if no module
+     * is ready.
+     */
+    module_task_cb* pop_ready_module();
+
+    /**
+     * a_task_cb used more than its share while other modules are waiting for a worker.
+     */
+    bool is_over_share( module_task_cb const& a_task_cb )const;
+
+    /**
+     * Take the next batch of a_task_cb's pending tasks, at most s_max_sequence_batch.
+     * The rest keep waiting. Should hold a_task_cb's lock.
+     */
+    std::vector<std::shared_ptr<abstract_task>> take_pending_batch( module_task_cb& a_task_cb );
+
+    /**
+     * Hand ready modules to idle workers.
+     */
+    void dispatch_ready_modules();
+
     void schedule_immediately_task
         (
         std::shared_ptr<abstract_task> a_task,
-        std::string const& a_module
+        module_id a_module
         );
 
     void schedule_concurrently_task
@@ -163,20 +599,192 @@ private:
         std::shared_ptr<abstract_task> a_task
         );
 
+    /**
+     * Schedule some concurrently executing tasks, wake idle workers only once.
+     */
+    void schedule_concurrently_tasks
+        (
+        std::vector<std::shared_ptr<abstract_task>> a_tasks
+        );
+
+    /**
+     * Put a_task into a_current_worker's local queue or the backlog.
+     */
+    void push_concurrently_task
+        (
+        std::shared_ptr<abstract_task> a_task,
+        abstract_worker* a_current_worker
+        );
+
+    /**
+     * Hand the backlog to idle workers after concurrently executing tasks were pushed.
+     */
+    void dispatch_concurrently_tasks();
+
     void schedule_handler_task
         (
         std::shared_ptr<abstract_task> a_task
         );
 
+    /**
+     * Post a_task to the own thread of a dedicated thread module, start the thread
+     * if it has not.
+     */
+    void schedule_dedicated_task
+        (
+        module_task_cb& a_task_cb,
+        std::shared_ptr<abstract_task> a_task
+        );
+
+    /**
+     * Start a thread for a dedicated thread module. Should hold a_task_cb's lock.
+     */
+    void start_dedicated_worker( module_task_cb& a_task_cb );
+
+    /**
+     * Stop the thread of a module which is not dedicated thread module any more.
+     * Should hold a_task_cb's lock.
+     */
+    void stop_dedicated_worker( module_task_cb& a_task_cb );
+
     std::shared_ptr<abstract_worker> make_worker();
 
-    mutable std::recursive_mutex m_mutex;
-    std::unordered_map<std::string, module_task_cb> m_modules_shcedule;
+    /**
+     * Cache a concurrently executing task which no worker can execute right now.
+     */
+    void push_backlog_task( std::shared_ptr<abstract_task> a_task );
+
+    /**
+     * Take a cached concurrently executing task, higher priority lanes first.
+     * Return empty if no task cached.
+     */
+    std::shared_ptr<abstract_task> pop_backlog_task();
+
+    /**
+     * Take the earliest deadline task of a lane, or the oldest one if none has a
+     * deadline. Expired tasks are dropped. Return empty if the lane is empty.
+     */
+    std::shared_ptr<abstract_task> pop_backlog_task( size_t a_lane );
+
+    size_t backlog_size_approx()const;
+
+    /**
+     * Steal a concurrently executing task from a worker's local queue. a_thief will
+     * not be a victim. Return empty if no task can be stolen.
+     */
+    std::shared_ptr<abstract_task> steal_task( abstract_worker* a_thief );
+
+    /**
+     * Hand cached or stealable concurrently executing tasks to idle workers,
+     * recruit new workers if need.
+     */
+    void dispatch_backlog();
+
+    /**
+     * Put a_worker at the front of the idle list. Must hold m_mutex.
+     * It does not retire any worker, the caller does if it wants.
+     */
+    void link_idle_worker( abstract_worker* a_worker );
+
+    /**
+     * Take a_worker out of the idle list and mark it working. Must hold m_mutex.
+     * Return false if a_worker is not idle.
+     */
+    bool unlink_idle_worker( abstract_worker* a_worker );
+
+    /**
+     * Lock order: module_task_cb::m_mutex, then m_mutex. Never lock a module
+     * control block while holding m_mutex.
+     */
+    mutable std::recursive_mutex m_mutex; // Protect the worker lists
+    mutable std::shared_mutex m_modules_mutex; // Protect m_modules_shcedule itself, not the control blocks
+    std::unordered_map<std::string, std::unique_ptr<module_task_cb>> m_modules_shcedule;
+    module_id_table<std::atomic<module_task_cb*>> m_module_cbs; // Indexed by module_id, set once a control block created
     uint32_t m_next_worker_id = 0;
-    uint32_t m_schedule_timer_id = 0;
-    std::vector<std::shared_ptr<abstract_worker>> m_idle_worker; // The workers have no work to do
-    std::vector<std::shared_ptr<abstract_worker>> m_working_worker; // The workers are working
-    std::vector<std::shared_ptr<abstract_task>>   m_work_need_assign;
+    std::vector<uint32_t> m_worker_cpus; // Protected by m_mutex
+    bool m_pin_each_worker = false;
+    uint32_t m_next_pinned_cpu = 0;
+    uint32_t m_next_numa_node = 0;
+
+    /**
+     * NUMA nodes discovered at construction, never changed after that.
+     */
+    struct numa_node
+    {
+        std::vector<uint32_t> m_cpus;
+        std::atomic_uint64_t m_local_claim_count = 0;
+        std::atomic_uint64_t m_remote_claim_count = 0;
+        std::atomic_uint64_t m_local_steal_count = 0;
+        std::atomic_uint64_t m_remote_steal_count = 0;
+    };
+    std::vector<std::unique_ptr<numa_node>> m_numa_nodes;
+    std::vector<int32_t> m_cpu_numa_node; // Indexed by CPU
+    std::atomic_uint32_t m_schedule_timer_id = 0;
+    abstract_worker* m_idle_head = nullptr; // Intrusive list of the workers have no work to do
+    abstract_worker* m_idle_tail = nullptr; // The one idle for the longest time
+    uint32_t m_working_worker_count = 0;
+    uint32_t m_idle_low_water = 0; // The least idle workers in current retire period
+    std::atomic<abstract_worker*> m_caller_worker = nullptr; // Occupies the thread called run, never retired
+    int64_t m_retire_period_start = 0;
+
+    std::atomic_uint32_t m_min_worker_num = 0;
+    std::atomic_uint32_t m_max_worker_num = 0;
+    std::atomic_int64_t m_max_task_wait_time = 0; // nanoseconds
+    std::atomic_int64_t m_idle_retire_time = 0; // nanoseconds
+    std::atomic_int64_t m_autoscale_interval = 0; // nanoseconds
+    std::atomic_int64_t m_last_grow_time = 0;
+
+    /**
+     * Autoscaler state and counters
+     */
+    std::atomic_int64_t m_max_observed_wait = 0; // Longest wait picked up since the last sample
+    int64_t m_backlog_seen_time = 0; // Since when the samples keep seeing a backlog without progress
+    std::atomic_size_t m_sampled_backlog_length = 0;
+    std::atomic_int64_t m_sampled_oldest_wait = 0;
+    std::atomic_uint32_t m_sampled_utilization = 0; // Per mille
+    std::atomic_uint64_t m_sample_count = 0;
+    std::atomic_uint64_t m_latency_miss_count = 0;
+    std::atomic_uint64_t m_grow_count = 0;
+    std::atomic_uint64_t m_grow_blocked_count = 0;
+    std::atomic_uint64_t m_retire_count = 0;
+    std::atomic_uint64_t m_expired_task_count = 0;
+    std::atomic_uint32_t m_blocked_worker_count = 0; // Workers inside a blocking_guard
+    std::atomic_uint64_t m_compensation_count = 0;
+    std::atomic_bool m_stopping = false; // Between stop and the next run, posted tasks are cancelled
+    std::atomic_uint32_t m_posting_count = 0; // post_task calls in progress, stop clears the queues after them
+    std::atomic_size_t m_cancelled_task_count = 0;
+
+    /**
+     * Concurrently executing tasks waiting for a worker, one lane per task_priority.
+     * Tasks with a deadline are kept in a heap and go before the FIFO ones.
+     */
+    struct backlog_lane
+    {
+        mpmc_queue<std::shared_ptr<abstract_task>> m_work_need_assign{ s_backlog_capacity };
+        std::mutex m_overflow_mutex;
+        std::list<std::shared_ptr<abstract_task>> m_work_overflow; // Used when m_work_need_assign is full
+        std::atomic_size_t m_overflow_size = 0;
+        std::mutex m_deadline_mutex;
+        std::vector<std::shared_ptr<abstract_task>> m_deadline_heap; // Earliest deadline at front
+        std::atomic_size_t m_deadline_size = 0;
+    };
+    backlog_lane m_backlog[s_task_priority_count];
+
+    /**
+     * Min heap by virtual runtime of modules which have pending tasks but no executing
+     * worker.
+     */
+    std::mutex m_ready_mutex;
+    std::vector<std::pair<int64_t, module_task_cb*>> m_ready_heap;
+    std::atomic_uint32_t m_ready_module_count = 0;
+    std::atomic_int64_t m_ready_min_vruntime = 0; // Virtual runtime of the heap top
+    std::atomic_int64_t m_min_vruntime = 0; // Never decreases. A module became ready is not put far behind it
+
+    mutable std::shared_mutex m_stealable_mutex;
+    std::vector<std::shared_ptr<abstract_worker>> m_stealable_workers; // All alive workers, own them
+
+    std::atomic_uint32_t m_idle_worker_count = 0;   // Length of the idle list
+    std::atomic_uint32_t m_worker_count = 0;        // Idle ones and m_working_worker_count
 };
 
 }
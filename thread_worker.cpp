@@ -75,30 +75,197 @@ void thread_worker::run
 
 void thread_worker::post_task( std::shared_ptr<abstract_task> a_task )
 {
+#if FRAMEWORK_ENABLE_TASK_DEBUG_INFO
     std::string const& debug_info = a_task->get_debug_info();
     if( !debug_info.empty() )
     {
         LogUtilInfo() << "post task. debug info: " << debug_info;
     }
-    std::unique_lock<std::mutex> locker( m_mutex );
-    m_tasks.emplace_back( std::move( a_task ) );
-    locker.unlock();
-
-    m_condition_variable.notify_all();
+#endif
+    push_posted_task( std::move( a_task ) );
+    m_has_posted_task.store( true );
+    wake_up();
 }
 
 void thread_worker::post_task( std::vector<std::shared_ptr<abstract_task>> a_tasks )
 {
-    using iter_t = std::vector<std::shared_ptr<abstract_task>>::iterator;
-    std::unique_lock<std::mutex> locker( m_mutex );
-    m_tasks.insert( m_tasks.end(),
-        std::move_iterator<iter_t>( a_tasks.begin() ),
-        std::move_iterator<iter_t>( a_tasks.end() )
-        );
+    for( auto& ele : a_tasks )
+    {
+        push_posted_task( std::move( ele ) );
+    }
+    m_has_posted_task.store( true );
+    wake_up();
+}
 
-    locker.unlock();
+void thread_worker::push_posted_task( std::shared_ptr<abstract_task> a_task )
+{
+    inbox_lane& lane = m_inbox[static_cast< size_t >( a_task->get_priority() )];
+    if( 0 == lane.m_overflow_size.load() && lane.m_ring.try_push( std::move( a_task ) ) )
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> locker( lane.m_overflow_mutex );
+    lane.m_overflow.emplace_back( std::move( a_task ) );
+    lane.m_overflow_size.fetch_add( 1 );
+}
+
+void thread_worker::drain_lane
+    (
+    inbox_lane& a_lane,
+    std::vector<std::shared_ptr<abstract_task>>& a_tasks
+    )
+{
+    std::shared_ptr<abstract_task> task;
+    size_t budget = a_lane.m_ring.capacity();
+    while( budget > 0 && a_lane.m_ring.try_pop( task ) )
+    {
+        a_tasks.emplace_back( std::move( task ) );
+        --budget;
+    }
+
+    if( 0 == a_lane.m_overflow_size.load() )
+    {
+        return;
+    }
+
+    /**
+     * A producer may have pushed into the ring just before the overflow list became
+     * not empty. Its later tasks are in the overflow list, so take the ring again
+     * first. No one pushes into the ring while the overflow list is not empty.
+     */
+    std::lock_guard<std::mutex> locker( a_lane.m_overflow_mutex );
+    while( a_lane.m_ring.try_pop( task ) )
+    {
+        a_tasks.emplace_back( std::move( task ) );
+    }
+
+    for( auto& ele : a_lane.m_overflow )
+    {
+        a_tasks.emplace_back( std::move( ele ) );
+    }
+    a_lane.m_overflow.clear();
+    a_lane.m_overflow_size.store( 0 );
+}
+
+void thread_worker::wake_up()
+{
+    // Pairs with wait_for_posted_task: either it sees the posted tasks or we see it parked.
+    m_post_epoch.fetch_add( 1 );
+    if( m_parked.load() )
+    {
+        m_post_epoch.notify_one();
+    }
+}
+
+void thread_worker::wait_for_posted_task()
+{
+    while( m_busy_poll.load( std::memory_order_relaxed ) )
+    {
+        if( m_has_posted_task.load() )
+        {
+            return;
+        }
+    }
+
+    for( uint32_t i = 0; i < s_idle_spin_count + s_idle_yield_count; ++i )
+    {
+        if( m_has_posted_task.load() )
+        {
+            return;
+        }
+
+        if( i >= s_idle_spin_count )
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    while( true )
+    {
+        uint32_t epoch = m_post_epoch.load();
+        m_parked.store( true );
+        if( m_has_posted_task.load() )
+        {
+            break;
+        }
+        m_post_epoch.wait( epoch );
+        m_parked.store( false );
+    }
+    m_parked.store( false );
+}
+
+bool thread_worker::push_local_task( std::shared_ptr<abstract_task>& a_task )
+{
+    abstract_task* raw_task = a_task.get();
+    raw_task->m_queued_self = std::move( a_task );
+    if( !m_local_tasks.push( raw_task ) )
+    {
+        a_task = std::move( raw_task->m_queued_self );
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<abstract_task> thread_worker::steal_task()
+{
+    abstract_task* raw_task = nullptr;
+    if( m_local_tasks.steal( raw_task ) )
+    {
+        return std::move( raw_task->m_queued_self );
+    }
+    return nullptr;
+}
+
+std::shared_ptr<abstract_task> thread_worker::pop_local_task()
+{
+    abstract_task* raw_task = nullptr;
+    if( m_local_tasks.pop( raw_task ) )
+    {
+        return std::move( raw_task->m_queued_self );
+    }
+    return nullptr;
+}
+
+void thread_worker::take_tasks( std::vector<std::shared_ptr<abstract_task>>& a_tasks )
+{
+    // Clear it before draining, a task posted meanwhile will set it again.
+    m_has_posted_task.exchange( false );
+    a_tasks.clear();
+    for( size_t lane = 0; lane < s_task_priority_count; ++lane )
+    {
+        inbox_lane& lane_tasks = m_inbox[lane];
+        if( lane_tasks.m_ring.empty() && 0 == lane_tasks.m_overflow_size.load() )
+        {
+            m_lane_passed_over[lane] = 0;
+        }
+        else if( a_tasks.empty() || m_lane_passed_over[lane] >= s_max_lane_passed_over )
+        {
+            drain_lane( lane_tasks, a_tasks );
+            m_lane_passed_over[lane] = 0;
+        }
+        else
+        {
+            ++m_lane_passed_over[lane];
+        }
+    }
+
+    if( has_posted_task() )
+    {
+        m_has_posted_task.store( true );
+    }
+}
 
-    m_condition_variable.notify_all();
+bool thread_worker::has_posted_task()const
+{
+    for( auto& lane : m_inbox )
+    {
+        if( !lane.m_ring.empty() || lane.m_overflow_size.load() > 0 )
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
 bool thread_worker::is_idle_for_long_time()
@@ -116,6 +283,11 @@ bool thread_worker::is_idle_for_long_time()
     return idle_long_time;
 }
 
+bool thread_worker::has_pending_task()
+{
+    return m_has_posted_task.load();
+}
+
 void thread_worker::exit_later()
 {
     auto fun = []()
@@ -125,9 +297,17 @@ void thread_worker::exit_later()
 
     m_is_running.exchange( false );
 
-    auto tsk = std::make_shared<executable_task>( fun );
+    auto tsk = make_task<executable_task>( fun );
     tsk->set_position( source_here );
-    post_task( tsk );
+    post_task( std::move( tsk ) );
+}
+
+void thread_worker::join()
+{
+    if( m_thread.joinable() && m_thread.get_id() != std::this_thread::get_id() )
+    {
+        m_thread.join();
+    }
 }
 
 uint64_t thread_worker::work_thread_id()
@@ -137,84 +317,174 @@ uint64_t thread_worker::work_thread_id()
 
 void thread_worker::set_worker_name( std::string a_name )
 {
-    auto tsk = std::make_shared<executable_task>();
-    tsk->set_fun( std::bind( &framework::set_thread_name, a_name ), abstract_module::s_task_runner_module_name );
-    post_task( tsk );
+    auto tsk = make_task<executable_task>();
+    tsk->set_fun( std::bind( &framework::set_thread_name, a_name ), abstract_module::get_task_runner_module_id() );
+    post_task( std::move( tsk ) );
+}
+
+void thread_worker::set_affinity( std::vector<uint32_t> a_cpus )
+{
+    std::lock_guard<std::mutex> locker( m_mutex );
+    m_wanted_cpus = std::move( a_cpus );
+    m_affinity_changed.store( true );
+}
+
+void thread_worker::set_dedicated( bool a_busy_poll )
+{
+    m_dedicated.store( true );
+    m_busy_poll.store( a_busy_poll );
+}
+
+void thread_worker::update_affinity()
+{
+    if( !m_affinity_changed.load( std::memory_order_relaxed ) || !m_affinity_changed.exchange( false ) )
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> locker( m_mutex );
+    std::vector<uint32_t> cpus = m_wanted_cpus;
+    locker.unlock();
+    set_current_thread_affinity( cpus );
 }
 
 void thread_worker::run_impl( std::shared_ptr<abstract_worker> a_current )
 {
     LogUtilDebug() << "thread work started.";
     m_thread_id = framework::get_current_thread_id();
+    bool dedicated = m_dedicated.load();
+    if( !dedicated )
+    {
+        // Concurrently executing tasks posted by a dedicated worker go to the pool.
+        thread_manager::set_current_worker( this );
+    }
 
     std::vector<std::shared_ptr<abstract_task>> tasks;
-    std::unique_lock<std::mutex> locker( m_mutex, std::defer_lock );
     bool ret = false;
+    bool quitted = false;
 
     framework::set_thread_name( "worker" );
 
-    while( true )
+    while( !quitted )
     {
         if( !m_is_running )
         {
+            quit( a_current, {} );
             break;
         }
 
-        locker.lock();
-        if( m_tasks.empty() )
+        if( !m_has_posted_task.load() )
         {
-            locker.unlock();
-            framework_manager::get_instance().get_thread_manager().push_idle_worker( a_current );
-            locker.lock();
-            m_condition_variable.wait( locker, [this]()
+            thread_manager& manager = framework_manager::get_instance().get_thread_manager();
+            std::shared_ptr<abstract_task> next_task;
+            if( !dedicated )
+            {
+                next_task = manager.pop_high_priority_task();
+                if( !next_task )
+                {
+                    next_task = pop_local_task();
+                }
+            }
+
+            if( next_task )
+            {
+                tasks.clear();
+                tasks.emplace_back( std::move( next_task ) );
+            }
+            else
+            {
+                if( !dedicated )
                 {
-                    return !m_tasks.empty();
+                    manager.push_idle_worker( a_current );
                 }
-                );
+                wait_for_posted_task();
+                take_tasks( tasks );
+            }
         }
-        tasks = std::move( m_tasks );
-        locker.unlock();
+        else
+        {
+            take_tasks( tasks );
+        }
+
+        // Whoever gave us these tasks may want them run on other CPUs.
+        update_affinity();
 
         for( auto it = tasks.begin(); it != tasks.end(); ++it )
         {
-            auto& the_task = ( *it );
-            thread_manager::set_current_thread_module_owner( the_task->get_target_module() );
-            auto_guard guard( []() { thread_manager::set_current_thread_module_owner( "" ); } );
-            bool exit = handle_task( the_task );
+            // The task is handed over, keep its target for accounting.
+            module_id target = ( *it )->get_target_module_id();
+            thread_manager::set_current_thread_module_owner( target );
+            auto_guard guard( []() { thread_manager::set_current_thread_module_owner( s_no_module_id ); } );
+            auto start_time = std::chrono::steady_clock::now();
+            bool exit = handle_task( std::move( *it ) );
+            m_last_executing_time = std::chrono::steady_clock::now();
+            framework_manager::get_instance().get_thread_manager().account_task_time
+                ( target, m_last_executing_time - start_time );
 
             if( exit || (!m_is_running) )
             {
-                framework_manager::get_instance().get_thread_manager().remove_worker( a_current );
                 std::vector<std::shared_ptr<abstract_task>> unhandled_task;
-                unhandled_task.assign( std::next( it ), tasks.end() );
-                if( !unhandled_task.empty() )
-                {
-                    framework_manager::get_instance().get_instance()
-                        .get_thread_manager().post_task( unhandled_task );
-                }
+                unhandled_task.assign( std::make_move_iterator( std::next( it ) ), std::make_move_iterator( tasks.end() ) );
+                quit( a_current, std::move( unhandled_task ) );
+                quitted = true;
                 break;
             }
-            m_last_executing_time = std::chrono::steady_clock::now();
         }
     }
 
     LogUtilDebug() << "thread work ended.";
 }
 
-bool thread_worker::handle_task( std::shared_ptr<abstract_task> const& a_task )
+void thread_worker::quit
+    (
+    std::shared_ptr<abstract_worker> const& a_current,
+    std::vector<std::shared_ptr<abstract_task>> a_unhandled_tasks
+    )
+{
+    // Tasks posted again should not go to our local queue.
+    thread_manager::set_current_worker( nullptr );
+    for( auto task = pop_local_task(); task; task = pop_local_task() )
+    {
+        a_unhandled_tasks.emplace_back( std::move( task ) );
+    }
+
+    // Thread manager takes the remained posted tasks and schedules all of them again.
+    framework_manager::get_instance().get_thread_manager().remove_worker( a_current, std::move( a_unhandled_tasks ) );
+}
+
+void thread_worker::take_posted_tasks( std::vector<std::shared_ptr<abstract_task>>& a_tasks )
 {
+    m_has_posted_task.store( false );
+    for( auto& lane : m_inbox )
+    {
+        while( !lane.m_ring.empty() || lane.m_overflow_size.load() > 0 )
+        {
+            drain_lane( lane, a_tasks );
+        }
+    }
+}
+
+bool thread_worker::handle_task( std::shared_ptr<abstract_task> a_task )
+{
+    if( framework_manager::get_instance().get_thread_manager().drop_expired_task( a_task ) )
+    {
+        return false;
+    }
+
+#if FRAMEWORK_ENABLE_TASK_DEBUG_INFO
     std::string const& debug_info = a_task->get_debug_info();
     if( !debug_info.empty() )
     {
         LogUtilInfo() << "handle task. task debug info: " << debug_info;
     }
+#endif
 
     bool handled = false;
     bool ret = false;
-    if( a_task->get_target_module() == abstract_module::s_task_runner_module_name ||
-        a_task->get_target_module().empty() )
+    if( a_task->get_target_module_id() == abstract_module::get_task_runner_module_id() ||
+        a_task->get_target_module_id() == s_no_module_id )
     {
-        auto runnable_task = std::dynamic_pointer_cast< executable_task >( a_task );
+        auto runnable_task = task_cast< executable_task >( a_task.get() );
         if( runnable_task )
         {
             ret = runnable_task->run_task();
@@ -231,7 +501,7 @@ bool thread_worker::handle_task( std::shared_ptr<abstract_task> const& a_task )
 
     if( !handled )
     {
-        framework_manager::get_instance().get_module_manager().schedule_task( a_task );
+        framework_manager::get_instance().get_module_manager().schedule_task( std::move( a_task ) );
     }
 
     return ret;
@@ -21,8 +21,8 @@
 */
 
 #pragma once
+#include <atomic>
 #include <chrono>
-#include <condition_variable>
 #include <string>
 #include <thread>
 #include <memory>
@@ -31,6 +31,8 @@
 
 #include "abstract_task.h"
 #include "abstract_worker.h"
+#include "mpmc_queue.h"
+#include "work_stealing_deque.h"
 
 namespace framework
 {
@@ -40,6 +42,30 @@ class thread_worker : public abstract_worker
 
 public:
 
+    /**
+     * How many tasks can be queued in a worker's local queue.
+     */
+    constexpr static size_t s_local_queue_capacity = 1024;
+
+    /**
+     * How many posted tasks of one priority can wait in the lock free inbox ring.
+     * More ones go to an overflow list.
+     */
+    constexpr static size_t s_inbox_capacity = 256;
+
+    /**
+     * A lower priority lane of posted tasks is taken anyway after passed over so
+     * many times, so it will not be starved.
+     */
+    constexpr static uint32_t s_max_lane_passed_over = 4;
+
+    /**
+     * A worker ran out of tasks checks its inbox s_idle_spin_count times, then yields
+     * s_idle_yield_count times before parking. Most ping-pong replies arrive meanwhile.
+     */
+    constexpr static uint32_t s_idle_spin_count = 128;
+    constexpr static uint32_t s_idle_yield_count = 16;
+
     thread_worker();
 
     ~thread_worker();
@@ -54,14 +80,28 @@ public:
 
     void post_task( std::vector<std::shared_ptr<abstract_task>> a_tasks )override;
 
+    bool push_local_task( std::shared_ptr<abstract_task>& a_task )override;
+
+    std::shared_ptr<abstract_task> steal_task()override;
+
     bool is_idle_for_long_time()override;
 
+    bool has_pending_task()override;
+
+    void take_posted_tasks( std::vector<std::shared_ptr<abstract_task>>& a_tasks )override;
+
     void exit_later()override;
 
+    void join()override;
+
     uint64_t work_thread_id()override;
 
     void set_worker_name( std::string a_name ) override;
 
+    void set_affinity( std::vector<uint32_t> a_cpus ) override;
+
+    void set_dedicated( bool a_busy_poll ) override;
+
 private:
 
     void run_impl( std::shared_ptr<abstract_worker> a_current );
@@ -70,13 +110,85 @@ private:
      * Handle one task.
      * Return true then exit current thread
      */
-    bool handle_task( std::shared_ptr<abstract_task> const& a_task );
+    bool handle_task( std::shared_ptr<abstract_task> a_task );
+
+    /**
+     * Take the newest task from local queue. Return empty if local queue is empty.
+     */
+    std::shared_ptr<abstract_task> pop_local_task();
+
+    /**
+     * Posted tasks of one priority. Producers push into the lock free ring, and use
+     * the overflow list when the ring is full. While the overflow list is not empty,
+     * all posts go there, so the tasks from one producer keep their order.
+     */
+    struct inbox_lane
+    {
+        mpmc_queue<std::shared_ptr<abstract_task>> m_ring{ s_inbox_capacity };
+        std::mutex m_overflow_mutex;
+        std::vector<std::shared_ptr<abstract_task>> m_overflow; // Keeps its capacity
+        std::atomic_size_t m_overflow_size = 0;
+    };
+
+    void push_posted_task( std::shared_ptr<abstract_task> a_task );
+
+    /**
+     * Move a lane's tasks to the end of a_tasks in post order. Only called in the
+     * worker's thread.
+     */
+    void drain_lane
+        (
+        inbox_lane& a_lane,
+        std::vector<std::shared_ptr<abstract_task>>& a_tasks
+        );
+
+    /**
+     * Take the posted tasks to execute next, the highest priority lane and the
+     * starved lanes. a_tasks is reused, so draining allocates nothing in steady state.
+     */
+    void take_tasks( std::vector<std::shared_ptr<abstract_task>>& a_tasks );
+
+    bool has_posted_task()const;
+
+    /**
+     * Spin, yield, then park until a task is posted. A busy polling worker spins only.
+     */
+    void wait_for_posted_task();
+
+    /**
+     * Called after tasks posted. Wake the worker up only if it is parked.
+     */
+    void wake_up();
+
+    /**
+     * Apply the affinity requested by set_affinity, if changed. Only called in the
+     * worker's thread.
+     */
+    void update_affinity();
+
+    /**
+     * Leave the thread pool. a_unhandled_tasks and all tasks in local queue will
+     * be posted to thread pool again.
+     */
+    void quit
+        (
+        std::shared_ptr<abstract_worker> const& a_current,
+        std::vector<std::shared_ptr<abstract_task>> a_unhandled_tasks
+        );
 
     uint64_t m_thread_id = 0;
 
     std::mutex m_mutex;
-    std::condition_variable m_condition_variable;
-    std::vector<std::shared_ptr<abstract_task>> m_tasks;
+    std::atomic_bool m_has_posted_task = false; // Set after posting, cleared by the worker before draining
+    std::atomic_bool m_parked = false;
+    std::atomic_uint32_t m_post_epoch = 0; // A parked worker waits on it
+    std::vector<uint32_t> m_wanted_cpus; // Protected by m_mutex
+    std::atomic_bool m_affinity_changed = false;
+    std::atomic_bool m_dedicated = false; // Serves one module only, out of the pool
+    std::atomic_bool m_busy_poll = false;
+    inbox_lane m_inbox[s_task_priority_count]; // One lane per task_priority
+    uint32_t m_lane_passed_over[s_task_priority_count] = {};
+    work_stealing_deque<abstract_task*> m_local_tasks{ s_local_queue_capacity }; // Only concurrently executing tasks
     std::chrono::steady_clock::time_point m_last_executing_time;
 
     std::thread m_thread;
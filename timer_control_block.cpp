@@ -70,14 +70,14 @@ void timer_control_block::timer_triggered()
             timer_module->undregister_timer( id );
             return false;
         };
-        task = std::make_shared<executable_task>( fun );
+        task = make_task<executable_task>( fun );
         task->set_target_module( abstract_module::s_timer_module_name );
         task->set_source_module( abstract_module::s_timer_module_name );
         m_callback = []( uint32_t, std::string )
             {
                 return false;
             };
-        framework_manager::get_instance().get_thread_manager().post_task( task );
+        framework_manager::get_instance().get_thread_manager().post_task( std::move( task ) );
     }
 }
 
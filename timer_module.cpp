@@ -21,6 +21,7 @@
 */
 
 #include "timer_module.h"
+#include "blocking_guard.h"
 #include "abstract_task.h"
 #include "executable_task.h"
 #include "log_util.h"
@@ -51,7 +52,9 @@ class timer_module_timer_task : public abstract_task
 public:
 
     timer_module_timer_task() : schedule_duration(0)
-    {}
+    {
+        set_task_kind( task_kind_of<timer_module_timer_task>() );
+    }
 
     timer_module_task_type type = timer_module_task_type::invalid_task_type;
     std::chrono::milliseconds schedule_duration;
@@ -105,7 +108,7 @@ void timer_module::deinitialize()
 void timer_module::handle_task( std::shared_ptr<abstract_task> a_task )
 {
     std::shared_ptr<timer_module_timer_task> task;
-    task = std::dynamic_pointer_cast<timer_module_timer_task>( a_task );
+    task = task_cast<timer_module_timer_task>( std::move( a_task ) );
     if( !task )
     {
         return;
@@ -116,14 +119,24 @@ void timer_module::handle_task( std::shared_ptr<abstract_task> a_task )
         return;
     }
 
-    std::unique_lock<std::mutex> locker( m_condition_mutex );
     if( task->schedule_duration > std::chrono::milliseconds( 0 ) )
     {
+        // Sleeping here takes a worker from the pool, let the pool make up for it.
+        blocking_guard guard;
+        std::unique_lock<std::mutex> locker( m_condition_mutex );
+        if( m_stopped.load() )
+        {
+            return;
+        }
         m_condition_waiting = true;
         m_condition.wait_for( locker, task->schedule_duration );
+        m_condition_waiting = false;
+    }
+    else
+    {
+        std::lock_guard<std::mutex> locker( m_condition_mutex );
+        m_condition_waiting = false;
     }
-    m_condition_waiting = false;
-    locker.unlock();
 
     handle_timer_expired();
 }
@@ -169,6 +182,12 @@ uint32_t timer_module::register_timer
     std::string a_handle_module
     )
 {
+    if( m_stopped.load() )
+    {
+        LogUtilWarning() << "timer module stopped, can not register timer " << a_timer_name;
+        return 0;
+    }
+
     std::shared_ptr<timer_control_block> timer = std::make_shared<timer_control_block>();
     timer->set_timeout_callback( a_expire_callback );
     timer->set_interval( static_cast< uint32_t >( a_interval.count() ) );
@@ -231,6 +250,19 @@ void timer_module::undregister_timer( uint32_t a_timer_id )
     }
 }
 
+void timer_module::stop_all_timers()
+{
+    {
+        std::lock_guard<std::recursive_mutex> locker( m_mutex );
+        m_timers.clear();
+    }
+
+    // The waiting schedule task finds no timer, then it ends without scheduling again.
+    std::lock_guard<std::mutex> locker( m_condition_mutex );
+    m_stopped.store( true );
+    m_condition.notify_all();
+}
+
 void timer_module::handle_timer_expired()
 {
     std::unique_lock<std::recursive_mutex> locker( m_mutex );
@@ -253,7 +285,6 @@ void timer_module::handle_timer_expired()
                 << to_booting_time_stamp( executeTime );
         }
 
-        int interval = _timer->get_interval();
         std::shared_ptr<executable_task> task;
         auto fun = _timer->get_timeout_callback();
         uint32_t timer_id = _timer->get_timer_id();
@@ -263,28 +294,31 @@ void timer_module::handle_timer_expired()
         LogTimerDebug() << "timer: " << _timer->get_timer_name() << " remains " << remain_trigger_times
             << ", current execute time: " << to_booting_time_stamp( executeTime ) << ", current time: " << to_booting_time_stamp( curTime );
 
-        task = std::make_shared<executable_task>( [fun, timer_id, timer_name, executeTime, interval, remain_trigger_times]()
+        task = make_task<executable_task>( [fun, timer_id, timer_name, remain_trigger_times]()
                 {
-                    int64_t curTime = get_system_booting_time();
-                    if( curTime - executeTime > 300 && remain_trigger_times > 0 )
-                    {
-                        /**
-                         * If the there are many task in thread pool need to execute, then the repeat timer
-                         * may execute many times at the same time. eg. if we have a debug break point here,
-                         * then other thread is running and will run the timer so this case may be happen.
-                         * So we need add a check here to avoid that. That is, for instance we have registered
-                         * a repeating timer with interval is 1 seconds. And the add a debug break pointer here,
-                         * then the timer thread will add 1, 2, 3, 4, 5, 6, 7 second timer event in thread pool.
-                         * But all these timer event will execute at 7 second. So that unexpected case happen. We
-                         * need avoid this. Here checked time is 300 milliseconds.
-                         */
-                        return false;
-                    }
-
                     LogTimerDebug() << "trigger timer: " << timer_name << ", remain " << remain_trigger_times;
                     fun( timer_id, timer_name );
                     return false;
                 } );
+
+        // The timer is due, run it before the tasks without deadline.
+        auto now = std::chrono::steady_clock::now();
+        task->set_deadline( now );
+        if( remain_trigger_times > 0 )
+        {
+            /**
+             * If the there are many task in thread pool need to execute, then the repeat timer
+             * may execute many times at the same time. eg. if we have a debug break point here,
+             * then other thread is running and will run the timer so this case may be happen.
+             * So we need avoid that. That is, for instance we have registered a repeating timer
+             * with interval is 1 seconds. And the add a debug break pointer here, then the timer
+             * thread will add 1, 2, 3, 4, 5, 6, 7 second timer event in thread pool. But all these
+             * timer event will execute at 7 second. So that unexpected case happen. The thread
+             * manager drops it if it has not run 300 milliseconds after the expected time.
+             */
+            task->set_expiry_time( now + std::chrono::milliseconds( 300 - diff ) );
+        }
+
         std::string handle_module = _timer->get_handle_module();
         if( !handle_module.empty() )
         {
@@ -299,7 +333,7 @@ void timer_module::handle_timer_expired()
         }
 
         task->set_source_module( get_name() );
-        framework_manager::get_instance().get_thread_manager().post_task( task );
+        framework_manager::get_instance().get_thread_manager().post_task( std::move( task ) );
 
         _timer->timer_triggered();
         remain_trigger_times = _timer->get_remain_trigger_timers();
@@ -356,7 +390,7 @@ void timer_module::make_schedule_task_if_need( int64_t a_front_time_to_execute )
     LogTimerDebug() << "wait until " << to_booting_time_stamp( m_weak_up_time );
     task->schedule_duration = std::chrono::milliseconds( a_front_time_to_execute );
 
-    framework_manager::get_instance().get_thread_manager().post_task( task );
+    framework_manager::get_instance().get_thread_manager().post_task( std::move( task ) );
 }
 
 }
@@ -163,6 +163,12 @@ public:
      */
     void undregister_timer( uint32_t a_timer_id );
 
+    /**
+     * Cancel all timers and wake up the worker waiting for the next one, used when
+     * the framework stops. No timer can be registered after that.
+     */
+    void stop_all_timers();
+
 private:
 
     void handle_timer_expired();
@@ -177,6 +183,7 @@ private:
     std::mutex m_condition_mutex;
     std::condition_variable m_condition;
     std::atomic_bool m_condition_waiting = false;
+    std::atomic_bool m_stopped = false; // Protected by m_condition_mutex when set
     uint64_t m_weak_up_time = 0xFFFFFFFF; // The time from system up time to wake up
 };
 
@@ -0,0 +1,228 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace framework
+{
+
+template<typename signature_type>
+class unique_function;
+
+/**
+ * Move-only replacement of std::function for tasks. Callables which fit in the
+ * inline buffer and can be moved without throwing are stored in place, so posting
+ * a small lambda allocates nothing beyond the task itself. Bigger ones go to heap.
+ * A callable returning void can be held by a non-void signature, then calling it
+ * returns a value initialized result, e.g. false for bool().
+ */
+template<typename return_type, typename... arg_types>
+class unique_function<return_type( arg_types... )>
+{
+
+public:
+
+    constexpr static size_t s_inline_size = 12 * sizeof( void* );
+
+    unique_function() noexcept = default;
+
+    unique_function( std::nullptr_t ) noexcept
+    {
+    }
+
+    template<typename fun_type, typename callable_type = std::decay_t<fun_type>,
+        typename = std::enable_if_t<!std::is_same_v<callable_type, unique_function> &&
+            std::is_invocable_v<callable_type&, arg_types...>>>
+    unique_function( fun_type&& a_fun )
+    {
+        if constexpr( std::is_constructible_v<bool, callable_type const&> )
+        {
+            // Empty std::function or null function pointer.
+            if( !static_cast<bool>( a_fun ) )
+            {
+                return;
+            }
+        }
+
+        if constexpr( is_inline<callable_type>() )
+        {
+            ::new( static_cast<void*>( m_buffer ) ) callable_type( std::forward<fun_type>( a_fun ) );
+        }
+        else
+        {
+            ::new( static_cast<void*>( m_buffer ) ) callable_type*( new callable_type( std::forward<fun_type>( a_fun ) ) );
+        }
+        m_ops = &s_ops<callable_type>;
+    }
+
+    unique_function( unique_function&& a_other ) noexcept
+    {
+        move_from( a_other );
+    }
+
+    unique_function& operator=( unique_function&& a_other ) noexcept
+    {
+        if( this != &a_other )
+        {
+            reset();
+            move_from( a_other );
+        }
+        return *this;
+    }
+
+    unique_function& operator=( std::nullptr_t ) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    unique_function( const unique_function& ) = delete;
+    unique_function& operator=( const unique_function& ) = delete;
+
+    ~unique_function()
+    {
+        reset();
+    }
+
+    explicit operator bool()const noexcept
+    {
+        return m_ops != nullptr;
+    }
+
+    return_type operator()( arg_types... a_args )
+    {
+        if( !m_ops )
+        {
+            throw std::bad_function_call();
+        }
+        return m_ops->invoke( m_buffer, std::forward<arg_types>( a_args )... );
+    }
+
+private:
+
+    struct operations
+    {
+        return_type( *invoke )( void* a_storage, arg_types&&... a_args );
+        void( *move )( void* a_to, void* a_from ) noexcept; // Move then destroy the source
+        void( *destroy )( void* a_storage ) noexcept;
+    };
+
+    template<typename callable_type>
+    constexpr static bool is_inline()
+    {
+        return sizeof( callable_type ) <= s_inline_size
+            && alignof( std::max_align_t ) % alignof( callable_type ) == 0
+            && std::is_nothrow_move_constructible_v<callable_type>;
+    }
+
+    template<typename callable_type>
+    static callable_type& get( void* a_storage )
+    {
+        if constexpr( is_inline<callable_type>() )
+        {
+            return *std::launder( static_cast<callable_type*>( a_storage ) );
+        }
+        else
+        {
+            return **std::launder( static_cast<callable_type**>( a_storage ) );
+        }
+    }
+
+    template<typename callable_type>
+    static return_type invoke( void* a_storage, arg_types&&... a_args )
+    {
+        callable_type& fun = get<callable_type>( a_storage );
+        if constexpr( std::is_void_v<return_type> ||
+            std::is_void_v<std::invoke_result_t<callable_type&, arg_types...>> )
+        {
+            std::invoke( fun, std::forward<arg_types>( a_args )... );
+            if constexpr( !std::is_void_v<return_type> )
+            {
+                return return_type{};
+            }
+        }
+        else
+        {
+            return std::invoke( fun, std::forward<arg_types>( a_args )... );
+        }
+    }
+
+    template<typename callable_type>
+    static void move( void* a_to, void* a_from ) noexcept
+    {
+        if constexpr( is_inline<callable_type>() )
+        {
+            callable_type& from = get<callable_type>( a_from );
+            ::new( a_to ) callable_type( std::move( from ) );
+            from.~callable_type();
+        }
+        else
+        {
+            ::new( a_to ) callable_type*( *std::launder( static_cast<callable_type**>( a_from ) ) );
+        }
+    }
+
+    template<typename callable_type>
+    static void destroy( void* a_storage ) noexcept
+    {
+        if constexpr( is_inline<callable_type>() )
+        {
+            get<callable_type>( a_storage ).~callable_type();
+        }
+        else
+        {
+            delete &get<callable_type>( a_storage );
+        }
+    }
+
+    template<typename callable_type>
+    constexpr static operations s_ops{ &invoke<callable_type>, &move<callable_type>, &destroy<callable_type> };
+
+    void move_from( unique_function& a_other ) noexcept
+    {
+        if( a_other.m_ops )
+        {
+            a_other.m_ops->move( m_buffer, a_other.m_buffer );
+            m_ops = a_other.m_ops;
+            a_other.m_ops = nullptr;
+        }
+    }
+
+    void reset() noexcept
+    {
+        if( m_ops )
+        {
+            m_ops->destroy( m_buffer );
+            m_ops = nullptr;
+        }
+    }
+
+    operations const* m_ops = nullptr;
+    alignas( std::max_align_t ) unsigned char m_buffer[s_inline_size];
+};
+
+}
@@ -31,6 +31,19 @@
 namespace framework
 {
 
+/**
+ * The process wide object_type, created at the first call and never destroyed.
+ * Pool workers are detached threads. If the process exits without
+ * framework_manager::stop, they keep running tasks while exit destroys the
+ * statics, so the objects they reach must not be destroyed.
+ */
+template<typename object_type>
+object_type& get_never_destroyed()
+{
+    static object_type* s_object = new object_type();
+    return *s_object;
+}
+
 /**
  * Cast a T value to string. And will fill all the string into a_buffer_start
  * Fot example, we want to cast an integer whose value is 10 to string into 4 digits.
@@ -0,0 +1,153 @@
+/*
+  Copyright (c) 2009-2025
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace framework
+{
+
+/**
+ * Bounded Chase-Lev work stealing deque.
+ * Only the owner thread can push and pop, at the bottom end (LIFO, so the
+ * owner runs the hottest task first). Any thread can steal from the top end.
+ * T must be trivially copyable since a thief may read a slot which the owner
+ * is overwriting, in that case the thief's CAS on top fails and the value it
+ * read is dropped.
+ * The capacity will be rounded up to a power of two.
+ */
+template<typename T>
+class work_stealing_deque
+{
+
+    static_assert( std::is_trivially_copyable_v<T>, "work_stealing_deque needs a trivially copyable type" );
+
+public:
+
+    constexpr static size_t s_cache_line_size = 64;
+
+    explicit work_stealing_deque( size_t a_capacity )
+    {
+        size_t capacity = 2;
+        while( capacity < a_capacity )
+        {
+            capacity <<= 1;
+        }
+
+        m_mask = static_cast< int64_t >( capacity - 1 );
+        m_slots = std::make_unique<std::atomic<T>[]>( capacity );
+    }
+
+    work_stealing_deque( const work_stealing_deque& ) = delete;
+    work_stealing_deque& operator=( const work_stealing_deque& ) = delete;
+
+    /**
+     * Owner only. Return false if the deque is full.
+     */
+    bool push( T a_value )
+    {
+        int64_t bottom = m_bottom.load( std::memory_order_relaxed );
+        int64_t top = m_top.load( std::memory_order_acquire );
+        if( bottom - top > m_mask )
+        {
+            return false;
+        }
+
+        m_slots[bottom & m_mask].store( a_value, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_release );
+        m_bottom.store( bottom + 1, std::memory_order_relaxed );
+        return true;
+    }
+
+    /**
+     * Owner only. Return false if the deque is empty.
+     */
+    bool pop( T& a_value )
+    {
+        int64_t bottom = m_bottom.load( std::memory_order_relaxed ) - 1;
+        m_bottom.store( bottom, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        int64_t top = m_top.load( std::memory_order_relaxed );
+
+        if( top > bottom )
+        {
+            m_bottom.store( bottom + 1, std::memory_order_relaxed );
+            return false;
+        }
+
+        a_value = m_slots[bottom & m_mask].load( std::memory_order_relaxed );
+        if( top == bottom )
+        {
+            // The last one, race with thieves.
+            bool won = m_top.compare_exchange_strong( top, top + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed );
+            m_bottom.store( bottom + 1, std::memory_order_relaxed );
+            return won;
+        }
+
+        return true;
+    }
+
+    /**
+     * Any thread. Return false if the deque is empty or lost the race with
+     * other thieves or the owner.
+     */
+    bool steal( T& a_value )
+    {
+        int64_t top = m_top.load( std::memory_order_acquire );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        int64_t bottom = m_bottom.load( std::memory_order_acquire );
+        if( top >= bottom )
+        {
+            return false;
+        }
+
+        a_value = m_slots[top & m_mask].load( std::memory_order_relaxed );
+        return m_top.compare_exchange_strong( top, top + 1,
+            std::memory_order_seq_cst, std::memory_order_relaxed );
+    }
+
+    size_t size_approx()const
+    {
+        int64_t bottom = m_bottom.load( std::memory_order_relaxed );
+        int64_t top = m_top.load( std::memory_order_relaxed );
+        return bottom > top ? static_cast< size_t >( bottom - top ) : 0;
+    }
+
+    bool empty()const
+    {
+        return size_approx() == 0;
+    }
+
+private:
+
+    alignas( s_cache_line_size ) std::atomic<int64_t> m_top{ 0 };
+    alignas( s_cache_line_size ) std::atomic<int64_t> m_bottom{ 0 };
+    alignas( s_cache_line_size ) int64_t m_mask = 0;
+    std::unique_ptr<std::atomic<T>[]> m_slots;
+};
+
+}